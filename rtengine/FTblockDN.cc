@@ -83,6 +83,15 @@ extern MyMutex *fftwMutex;
 namespace
 {
 
+#ifdef __SSE2__
+template <bool useUpperBound>
+inline void storeMedian(float &out, const float &in, vfloat medianv, vfloat upperBoundv)
+{
+    // when using an upper bound, only pixels <= upperBound are replaced by the median
+    STVFU(out, useUpperBound ? vself(vmaskf_le(LVFU(in), upperBoundv), medianv, LVFU(in)) : medianv);
+}
+#endif
+
 template <bool useUpperBound>
 void do_median_denoise(float **src, float **dst, float upperBound, int width, int height, ImProcFunctions::Median medianType, int iterations, int numThreads, float **buffer)
 {
@@ -143,6 +152,9 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
 
     float ** medianIn, ** medianOut = nullptr;
     int BufferIndex = 0;
+#ifdef __SSE2__
+    const vfloat upperBoundv = F2V(upperBound);
+#endif
 
     for (int iteration = 1; iteration <= iterations; ++iteration) {
         medianIn = medBuffer[BufferIndex];
@@ -169,6 +181,25 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
 
             switch (medianType) {
                 case Median::TYPE_3X3_SOFT: {
+#ifdef __SSE2__
+
+                    for (; j < width - border - 3; j += 4) {
+                        storeMedian<useUpperBound>(
+                            medianOut[i][j],
+                            medianIn[i][j],
+                            median(
+                                LVFU(medianIn[i - 1][j]),
+                                LVFU(medianIn[i][j - 1]),
+                                LVFU(medianIn[i][j]),
+                                LVFU(medianIn[i][j + 1]),
+                                LVFU(medianIn[i + 1][j])
+                            ),
+                            upperBoundv
+                        );
+                    }
+
+#endif
+
                     for (; j < width - border; ++j) {
                         if (!useUpperBound || medianIn[i][j] <= upperBound) {
                             medianOut[i][j] = median(
@@ -187,6 +218,29 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
                 }
 
                 case Median::TYPE_3X3_STRONG: {
+#ifdef __SSE2__
+
+                    for (; j < width - border - 3; j += 4) {
+                        storeMedian<useUpperBound>(
+                            medianOut[i][j],
+                            medianIn[i][j],
+                            median(
+                                LVFU(medianIn[i - 1][j - 1]),
+                                LVFU(medianIn[i - 1][j]),
+                                LVFU(medianIn[i - 1][j + 1]),
+                                LVFU(medianIn[i][j - 1]),
+                                LVFU(medianIn[i][j]),
+                                LVFU(medianIn[i][j + 1]),
+                                LVFU(medianIn[i + 1][j - 1]),
+                                LVFU(medianIn[i + 1][j]),
+                                LVFU(medianIn[i + 1][j + 1])
+                            ),
+                            upperBoundv
+                        );
+                    }
+
+#endif
+
                     for (; j < width - border; ++j) {
                         if (!useUpperBound || medianIn[i][j] <= upperBound) {
                             medianOut[i][j] = median(
@@ -209,6 +263,33 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
                 }
 
                 case Median::TYPE_5X5_SOFT: {
+#ifdef __SSE2__
+
+                    for (; j < width - border - 3; j += 4) {
+                        storeMedian<useUpperBound>(
+                            medianOut[i][j],
+                            medianIn[i][j],
+                            median(
+                                LVFU(medianIn[i - 2][j]),
+                                LVFU(medianIn[i - 1][j - 1]),
+                                LVFU(medianIn[i - 1][j]),
+                                LVFU(medianIn[i - 1][j + 1]),
+                                LVFU(medianIn[i][j - 2]),
+                                LVFU(medianIn[i][j - 1]),
+                                LVFU(medianIn[i][j]),
+                                LVFU(medianIn[i][j + 1]),
+                                LVFU(medianIn[i][j + 2]),
+                                LVFU(medianIn[i + 1][j - 1]),
+                                LVFU(medianIn[i + 1][j]),
+                                LVFU(medianIn[i + 1][j + 1]),
+                                LVFU(medianIn[i + 2][j])
+                            ),
+                            upperBoundv
+                        );
+                    }
+
+#endif
+
                     for (; j < width - border; ++j) {
                         if (!useUpperBound || medianIn[i][j] <= upperBound) {
                             medianOut[i][j] = median(
@@ -237,9 +318,10 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
                 case Median::TYPE_5X5_STRONG: {
 #ifdef __SSE2__
 
-                    for (; !useUpperBound && j < width - border - 3; j += 4) {
-                        STVFU(
+                    for (; j < width - border - 3; j += 4) {
+                        storeMedian<useUpperBound>(
                             medianOut[i][j],
+                            medianIn[i][j],
                             median(
                                 LVFU(medianIn[i - 2][j - 2]),
                                 LVFU(medianIn[i - 2][j - 1]),
@@ -266,7 +348,8 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
                                 LVFU(medianIn[i + 2][j]),
                                 LVFU(medianIn[i + 2][j + 1]),
                                 LVFU(medianIn[i + 2][j + 2])
-                            )
+                            ),
+                            upperBoundv
                         );
                     }
 
@@ -313,14 +396,14 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
 #ifdef __SSE2__
                     std::array<vfloat, 49> vpp ALIGNED16;
 
-                    for (; !useUpperBound && j < width - border - 3; j += 4) {
+                    for (; j < width - border - 3; j += 4) {
                         for (int kk = 0, ii = -border; ii <= border; ++ii) {
                             for (int jj = -border; jj <= border; ++jj, ++kk) {
                                 vpp[kk] = LVFU(medianIn[i + ii][j + jj]);
                             }
                         }
 
-                        STVFU(medianOut[i][j], median(vpp));
+                        storeMedian<useUpperBound>(medianOut[i][j], medianIn[i][j], median(vpp), upperBoundv);
                     }
 
 #endif
@@ -348,14 +431,14 @@ void do_median_denoise(float **src, float **dst, float upperBound, int width, in
 #ifdef __SSE2__
                     std::array<vfloat, 81> vpp ALIGNED16;
 
-                    for (; !useUpperBound && j < width - border - 3; j += 4) {
+                    for (; j < width - border - 3; j += 4) {
                         for (int kk = 0, ii = -border; ii <= border; ++ii) {
                             for (int jj = -border; jj <= border; ++jj, ++kk) {
                                 vpp[kk] = LVFU(medianIn[i + ii][j + jj]);
                             }
                         }
 
-                        STVFU(medianOut[i][j], median(vpp));
+                        storeMedian<useUpperBound>(medianOut[i][j], medianIn[i][j], median(vpp), upperBoundv);
                     }
 
 #endif
@@ -502,6 +585,8 @@ BENCHFUN
 
     MyMutex::MyLock lock(*fftwMutex);
 
+    Color::initDenoiseGammas();
+
     const nrquality nrQuality = (dnparams.smethod == "shal") ? QUALITY_STANDARD : QUALITY_HIGH;//shrink method
     const float qhighFactor = (nrQuality == QUALITY_HIGH) ? 1.f / static_cast<float>(settings->nrhigh) : 1.0f;
     const bool useNoiseCCurve = (noiseCCurve && noiseCCurve.getSum() > 5.f);
@@ -871,6 +956,10 @@ BENCHFUN
 
                 for (int tiletop = 0; tiletop < imheight; tiletop += tileHskip) {
                     for (int tileleft = 0; tileleft < imwidth ; tileleft += tileWskip) {
+                        if (isCancelled()) {
+                            continue;
+                        }
+
                         //printf("titop=%d tileft=%d\n",tiletop/tileHskip, tileleft/tileWskip);
                         pos = (tiletop / tileHskip) * numtiles_W + tileleft / tileWskip ;
                         int tileright = MIN(imwidth, tileleft + tilewidth);
@@ -3229,6 +3318,8 @@ void ImProcFunctions::RGB_denoise_info(Imagefloat * src, Imagefloat * provicalc,
         return;
     }
 
+    Color::initDenoiseGammas();
+
     int hei, wid;
     float** lumcalc;
     float** acalc;
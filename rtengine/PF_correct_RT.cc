@@ -42,6 +42,44 @@
 #include "StopWatch.h"
 #include "procparams.h"
 
+namespace
+{
+
+// 3x3 median of pixels spaced by 2, mirrored at the borders. Has to be called from inside an OpenMP parallel region
+void median3x3Spaced(const float* const* src, float** dst, int width, int height)
+{
+#ifdef _OPENMP
+    #pragma omp for nowait
+#endif
+
+    for (int i = 0; i < height; i++) {
+        const int ip = i < 2 ? i + 2 : i - 2;
+        const int in = i > height - 3 ? i - 2 : i + 2;
+        int j = 0;
+
+        for (; j < std::min(2, width); j++) {
+            dst[i][j] = rtengine::median(src[ip][j + 2], src[ip][j], src[ip][j + 2], src[i][j + 2], src[i][j], src[i][j + 2], src[in][j + 2], src[in][j], src[in][j + 2]);
+        }
+
+#ifdef __SSE2__
+
+        for (; j < width - 5; j += 4) {
+            STVFU(dst[i][j], rtengine::median(LVFU(src[ip][j - 2]), LVFU(src[ip][j]), LVFU(src[ip][j + 2]), LVFU(src[i][j - 2]), LVFU(src[i][j]), LVFU(src[i][j + 2]), LVFU(src[in][j - 2]), LVFU(src[in][j]), LVFU(src[in][j + 2])));
+        }
+
+#endif
+
+        for (; j < width; j++) {
+            const int jp = j < 2 ? j + 2 : j - 2;
+            const int jn = j > width - 3 ? j - 2 : j + 2;
+
+            dst[i][j] = rtengine::median(src[ip][jp], src[ip][j], src[ip][jn], src[i][jp], src[i][j], src[i][jn], src[in][jp], src[in][j], src[in][jn]);
+        }
+    }
+}
+
+}
+
 namespace rtengine
 {
 
@@ -654,36 +692,9 @@ void ImProcFunctions::Badpixelscam(CieImage * ncie, double radius, int thresh, i
             #pragma omp parallel
 #endif
             {
-#ifdef _OPENMP
-                #pragma omp for nowait // nowait because next loop inside this parallel region is independent on this one
-#endif
-
-                for (int i = 0; i < height; i++) {
-                    const int ip = i < 2 ? i + 2 : i - 2;
-                    const int in = i > height - 3 ? i - 2 : i + 2;
-
-                    for (int j = 0; j < width; j++) {
-                        const int jp = j < 2 ? j + 2 : j -2;
-                        const int jn = j > width - 3 ? j - 2 : j + 2;
-
-                        tmaa[i][j] = median(sraa[ip][jp], sraa[ip][j], sraa[ip][jn], sraa[i][jp], sraa[i][j], sraa[i][jn], sraa[in][jp], sraa[in][j], sraa[in][jn]);
-                    }
-                }
-
-#ifdef _OPENMP
-                #pragma omp for
-#endif
-                for (int i = 0; i < height; i++) {
-                    const int ip = i < 2 ? i + 2 : i - 2;
-                    const int in = i > height - 3 ? i - 2 : i + 2;
-
-                    for (int j = 0; j < width; j++) {
-                        const int jp = j < 2 ? j + 2 : j -2;
-                        const int jn = j > width - 3 ? j - 2 : j + 2;
-
-                        tmbb[i][j] = median(srbb[ip][jp], srbb[ip][j], srbb[ip][jn], srbb[i][jp], srbb[i][j], srbb[i][jn], srbb[in][jp], srbb[in][j], srbb[in][jn]);
-                    }
-                }
+                // nowait in median3x3Spaced because the second call is independent on the first one
+                median3x3Spaced(sraa, tmaa, width, height);
+                median3x3Spaced(srbb, tmbb, width, height);
             }
         }
 
@@ -872,9 +872,17 @@ void CameraConstantsStore::init(const Glib::ustring& baseDir, const Glib::ustrin
     }
 }
 
+void CameraConstantsStore::initDeferred(const Glib::ustring& baseDir, const Glib::ustring& userSettingsDir)
+{
+    deferredInit.set([this, baseDir, userSettingsDir]() {
+        init(baseDir, userSettingsDir);
+    });
+}
+
 CameraConstantsStore* CameraConstantsStore::getInstance()
 {
     static CameraConstantsStore instance_;
+    instance_.deferredInit.run();
     return &instance_;
 }
 
@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 
+#include "deferredinit.h"
+
 namespace Glib
 {
 
@@ -68,6 +70,7 @@ class CameraConstantsStore final
 {
 private:
     std::map<std::string, CameraConst *> mCameraConstants;
+    DeferredInit deferredInit;
 
     CameraConstantsStore();
     bool parse_camera_constants_file(const Glib::ustring& filename);
@@ -75,6 +78,8 @@ private:
 public:
     ~CameraConstantsStore();
     void init(const Glib::ustring& baseDir, const Glib::ustring& userSettingsDir);
+    /** Same as init(), but the files are only parsed when the store is first used */
+    void initDeferred(const Glib::ustring& baseDir, const Glib::ustring& userSettingsDir);
     static CameraConstantsStore *getInstance(void);
     const CameraConst *get(const char make[], const char model[]) const;
 };
@@ -25,6 +25,7 @@
 #include "opthelper.h"
 #include "iccstore.h"
 #include <iostream>
+#include <mutex>
 
 using namespace std;
 
@@ -42,9 +43,7 @@ LUTf Color::igammatab_srgb;
 LUTf Color::igammatab_srgb1;
 LUTf Color::gammatab_srgb;
 LUTf Color::gammatab_srgb1;
-LUTf Color::gammatab_srgb327;
 LUTf Color::gammatab_bt709;
-LUTf Color::igammatab_bt709;
 
 LUTf Color::denoiseGammaTab;
 LUTf Color::denoiseIGammaTab;
@@ -116,24 +115,10 @@ void Color::init ()
     gammatabThumb(maxindex, 0);
 
     igammatab_srgb(maxindex, 0);
-    igammatab_bt709(maxindex, 0);
     igammatab_srgb1(maxindex, 0);
     gammatab_srgb(maxindex, 0);
     gammatab_bt709(maxindex, 0);
     gammatab_srgb1(maxindex, 0);
-    gammatab_srgb327(32768, 0);
-
-    denoiseGammaTab(maxindex, 0);
-    denoiseIGammaTab(maxindex, 0);
-
-    igammatab_24_17(maxindex, 0);
-    gammatab_24_17a(maxindex, LUT_CLIP_ABOVE | LUT_CLIP_BELOW);
-    gammatab_13_2(maxindex, 0);
-    igammatab_13_2(maxindex, 0);
-    gammatab_115_2(maxindex, 0);
-    igammatab_115_2(maxindex, 0);
-    gammatab_145_3(maxindex, 0);
-    igammatab_145_3(maxindex, 0);
 
 #ifdef _OPENMP
     #pragma omp parallel sections
@@ -186,18 +171,6 @@ void Color::init ()
         }
 #ifdef _OPENMP
         #pragma omp section
-#endif
-        {
-            for (int i = 0; i < 32768; i++)
-            {
-                gammatab_srgb327[i] = gamma2(i / 32767.0);
-            }
-
-            gammatab_srgb327 *= 32767.f;
-            //  gamma2curve.share(gammatab_srgb, LUT_CLIP_BELOW | LUT_CLIP_ABOVE); // shares the buffer with gammatab_srgb but has different clip flags
-        }
-#ifdef _OPENMP
-        #pragma omp section
 #endif
         {
             for (int i = 0; i < maxindex; i++)
@@ -222,68 +195,6 @@ void Color::init ()
             }
         }
 
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-        // modify arbitrary data for Lab..I have test : nothing, gamma 2.6 11 - gamma 4 5 - gamma 5.5 10
-        // we can put other as gamma g=2.6 slope=11, etc.
-        // but noting to do with real gamma !!!: it's only for data Lab # data RGB
-        // finally I opted for gamma55 and with options we can change
-
-        switch(settings->denoiselabgamma) {
-            case 0:
-                for (int i = 0; i < maxindex; i++) {
-                    denoiseGammaTab[i] = 65535.0 * gamma26_11 (i / 65535.0);
-                }
-
-                break;
-
-            case 1:
-                for (int i = 0; i < maxindex; i++) {
-                    denoiseGammaTab[i] = 65535.0 * gamma4 (i / 65535.0);
-                }
-
-                break;
-
-            default:
-                for (int i = 0; i < maxindex; i++) {
-                    denoiseGammaTab[i] = 65535.0 * gamma55 (i / 65535.0);
-                }
-
-                break;
-        }
-
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-        // modify arbitrary data for Lab..I have test : nothing, gamma 2.6 11 - gamma 4 5 - gamma 5.5 10
-        // we can put other as gamma g=2.6 slope=11, etc.
-        // but noting to do with real gamma !!!: it's only for data Lab # data RGB
-        // finally I opted for gamma55 and with options we can change
-
-        switch(settings->denoiselabgamma) {
-            case 0:
-                for (int i = 0; i < maxindex; i++) {
-                    denoiseIGammaTab[i] = 65535.0 * igamma26_11 (i / 65535.0);
-                }
-
-                break;
-
-            case 1:
-                for (int i = 0; i < maxindex; i++) {
-                    denoiseIGammaTab[i] = 65535.0 * igamma4 (i / 65535.0);
-                }
-
-                break;
-
-            default:
-                for (int i = 0; i < maxindex; i++) {
-                    denoiseIGammaTab[i] = 65535.0 * igamma55 (i / 65535.0);
-                }
-
-                break;
-        }
-
 #ifdef _OPENMP
         #pragma omp section
 #endif
@@ -295,92 +206,108 @@ void Color::init ()
 #ifdef _OPENMP
         #pragma omp section
 #endif
+        linearGammaTRC = cmsBuildGamma(nullptr, 1.0);
+    }
+}
 
-        for (int i = 0; i < maxindex; i++) {
-            igammatab_bt709[i] = 65535.0 * igamma709(i / 65535.0);
-        }
-
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-
-        for (int i = 0; i < maxindex; i++) {
-            gammatab_13_2[i] = 65535.0 * gamma13_2 (i / 65535.0);
-        }
-
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-
-        for (int i = 0; i < maxindex; i++) {
-            igammatab_13_2[i] = 65535.0 * igamma13_2 (i / 65535.0);
-        }
-
-#ifdef _OPENMP
-        #pragma omp section
-#endif
+void Color::cleanup ()
+{
+    if (linearGammaTRC) {
+        cmsFreeToneCurve(linearGammaTRC);
+    }
+}
 
-        for (int i = 0; i < maxindex; i++) {
-            gammatab_115_2[i] = 65535.0 * gamma115_2 (i / 65535.0);
-        }
+namespace
+{
+std::once_flag denoiseGammasInitialized;
+std::once_flag lmmseGammasInitialized;
+std::once_flag extraGammasInitialized;
+std::once_flag munsellInitialized;
+}
 
-#ifdef _OPENMP
-        #pragma omp section
-#endif
+void Color::initDenoiseGammas ()
+{
+    std::call_once(denoiseGammasInitialized, []() {
+        constexpr auto maxindex = 65536;
 
-        for (int i = 0; i < maxindex; i++) {
-            igammatab_115_2[i] = 65535.0 * igamma115_2 (i / 65535.0);
-        }
+        denoiseGammaTab(maxindex, 0);
+        denoiseIGammaTab(maxindex, 0);
 
+        // modify arbitrary data for Lab..I have test : nothing, gamma 2.6 11 - gamma 4 5 - gamma 5.5 10
+        // we can put other as gamma g=2.6 slope=11, etc.
+        // but noting to do with real gamma !!!: it's only for data Lab # data RGB
+        // finally I opted for gamma55 and with options we can change
 #ifdef _OPENMP
-        #pragma omp section
+        #pragma omp parallel for
 #endif
-
         for (int i = 0; i < maxindex; i++) {
-            gammatab_145_3[i] = 65535.0 * gamma145_3 (i / 65535.0);
+            switch (settings->denoiselabgamma) {
+                case 0:
+                    denoiseGammaTab[i] = 65535.0 * gamma26_11(i / 65535.0);
+                    denoiseIGammaTab[i] = 65535.0 * igamma26_11(i / 65535.0);
+                    break;
+
+                case 1:
+                    denoiseGammaTab[i] = 65535.0 * gamma4(i / 65535.0);
+                    denoiseIGammaTab[i] = 65535.0 * igamma4(i / 65535.0);
+                    break;
+
+                default:
+                    denoiseGammaTab[i] = 65535.0 * gamma55(i / 65535.0);
+                    denoiseIGammaTab[i] = 65535.0 * igamma55(i / 65535.0);
+                    break;
+            }
         }
+    });
+}
 
-#ifdef _OPENMP
-        #pragma omp section
-#endif
+void Color::initLmmseGammas ()
+{
+    std::call_once(lmmseGammasInitialized, []() {
+        constexpr auto maxindex = 65536;
 
-        for (int i = 0; i < maxindex; i++) {
-            igammatab_145_3[i] = 65535.0 * igamma145_3 (i / 65535.0);
-        }
+        igammatab_24_17(maxindex, 0);
+        gammatab_24_17a(maxindex, LUT_CLIP_ABOVE | LUT_CLIP_BELOW);
 
 #ifdef _OPENMP
-        #pragma omp section
+        #pragma omp parallel for
 #endif
-
         for (int i = 0; i < maxindex; i++) {
             gammatab_24_17a[i] = gamma24_17(i / 65535.0);
+            igammatab_24_17[i] = 65535.0 * igamma24_17(i / 65535.0);
         }
+    });
+}
 
-#ifdef _OPENMP
-        #pragma omp section
-#endif
+void Color::initExtraGammas ()
+{
+    std::call_once(extraGammasInitialized, []() {
+        constexpr auto maxindex = 65536;
 
-        for (int i = 0; i < maxindex; i++) {
-            igammatab_24_17[i] = 65535.0 * igamma24_17 (i / 65535.0);
-        }
+        gammatab_13_2(maxindex, 0);
+        igammatab_13_2(maxindex, 0);
+        gammatab_115_2(maxindex, 0);
+        igammatab_115_2(maxindex, 0);
+        gammatab_145_3(maxindex, 0);
+        igammatab_145_3(maxindex, 0);
 
 #ifdef _OPENMP
-        #pragma omp section
+        #pragma omp parallel for
 #endif
-        initMunsell();
-
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-        linearGammaTRC = cmsBuildGamma(nullptr, 1.0);
-    }
+        for (int i = 0; i < maxindex; i++) {
+            gammatab_13_2[i] = 65535.0 * gamma13_2(i / 65535.0);
+            igammatab_13_2[i] = 65535.0 * igamma13_2(i / 65535.0);
+            gammatab_115_2[i] = 65535.0 * gamma115_2(i / 65535.0);
+            igammatab_115_2[i] = 65535.0 * igamma115_2(i / 65535.0);
+            gammatab_145_3[i] = 65535.0 * gamma145_3(i / 65535.0);
+            igammatab_145_3[i] = 65535.0 * igamma145_3(i / 65535.0);
+        }
+    });
 }
 
-void Color::cleanup ()
+void Color::initMunsell ()
 {
-    if (linearGammaTRC) {
-        cmsFreeToneCurve(linearGammaTRC);
-    }
+    std::call_once(munsellInitialized, buildMunsell);
 }
 
 void Color::rgb2lab01 (const Glib::ustring &profile, const Glib::ustring &profileW, float r, float g, float b, float &LAB_l, float &LAB_a, float &LAB_b, bool workingSpace)
@@ -2723,6 +2650,10 @@ void Color::gamutLchonly (float2 sincosval, float &Lprov1, float &Chprov1, const
  */
 void Color::LabGamutMunsell(float *labL, float *laba, float *labb, const int N, bool corMunsell, bool lumaMuns, bool isHLEnabled, bool gamut, const double wip[3][3])
 {
+    if (corMunsell) {
+        initMunsell();
+    }
+
 #ifdef __SSE2__
     // precalculate H and C using SSE
     float HHBuffer[N];
@@ -2902,7 +2833,7 @@ void Color::SkinSat (float lum, float hue, float chrom, float &satreduc)
  * errors due to a different illuminant "Daylight" than "C" are low, about 10%. For example, a theoretical correction of 0.1 radian will be made with a real correction of 0.09 or 0.11 depending on the color illuminant D50
  * errors due to the use of a very different illuminant "C", for example illuminant "A" (tungsten) are higher, about 20%. Theoretical correction of 0.52 radians will be made with a real correction of 0.42
  */
-void Color::initMunsell ()
+void Color::buildMunsell ()
 {
     const int maxInd  = 140;
     const int maxInd2 = 90;
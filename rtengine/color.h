@@ -75,8 +75,8 @@ private:
     static LUTf  _75GY30, _75GY40, _75GY50, _75GY60, _75GY70, _75GY80;
     static LUTf  _5GY30, _5GY40, _5GY50, _5GY60, _5GY70, _5GY80;
 
-    // Separated from init() to keep the code clear
-    static void initMunsell ();
+    // Separated from initMunsell() to keep the code clear
+    static void buildMunsell ();
     static double hue2rgb(double p, double q, double t);
     static float hue2rgbfloat(float p, float q, float t);
 #ifdef __SSE2__
@@ -145,15 +145,15 @@ public:
     static LUTf igammatab_srgb;
     static LUTf igammatab_srgb1;
     static LUTf gammatab_srgb;
-    static LUTf gammatab_srgb327;
     static LUTf gammatab_srgb1;
     static LUTf gammatab_bt709;
 
+    // look-up tables only needed by a few tools, filled on first use by initDenoiseGammas(),
+    // initLmmseGammas() and initExtraGammas()
     static LUTf denoiseGammaTab;
     static LUTf denoiseIGammaTab;
 
     static LUTf igammatab_24_17;
-    static LUTf igammatab_bt709;
     static LUTf gammatab_24_17a;
     static LUTf gammatab_13_2;
     static LUTf igammatab_13_2;
@@ -170,6 +170,13 @@ public:
     static void init ();
     static void cleanup ();
 
+    // These fill the look-up tables of the tools which need them, they can be called any number of times
+    // from any thread but have to be called before the tables are used
+    static void initDenoiseGammas ();  // denoiseGammaTab, denoiseIGammaTab
+    static void initLmmseGammas ();    // gammatab_24_17a, igammatab_24_17
+    static void initExtraGammas ();    // gammatab_13_2, gammatab_115_2, gammatab_145_3 and their inverses
+    static void initMunsell ();        // Munsell correction tables used by AllMunsellLch and LabGamutMunsell
+
     static inline float computeXYZ2LabY(float f)
     {
         if (f < 0.f) {
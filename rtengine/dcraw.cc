@@ -352,6 +352,31 @@ void CLASS read_shorts (ushort *pixel, int count)
 	  rtengine::swab ((char*)pixel, (char*)pixel, count*2);
 }
 
+/*
+   RT: returns the next size bytes of raw data in place, when the file is memory
+   mapped and the samples can be used as they are stored (native byte order,
+   aligned, Bayer or X-Trans sensor), nullptr otherwise. See RawImage::loadRaw
+ */
+const void * CLASS RT_map_raw_data (size_t size, size_t alignment)
+{
+#ifdef MYFILE_MMAP
+  if (filters > 1 && !fuji_width && (order == 0x4949) != (ntohs(0x1234) == 0x1234)) {
+    long pos = ftell(ifp);
+    const char *data = fmap (size, ifp);
+    if (data && reinterpret_cast<uintptr_t>(data) % alignment == 0)
+      return data;
+    fseek (ifp, pos, SEEK_SET);
+  }
+#endif
+  return nullptr;
+}
+
+bool CLASS RT_is_mapped (const void *p) const
+{
+  const char *c = static_cast<const char *>(p);
+  return p && ifp && c >= ifp->data && c < ifp->data + ifp->size;
+}
+
 void CLASS cubic_spline (const int *x_, const int *y_, const int len)
 {
   float **A, *b, *c, *d, *x, *y;
@@ -1179,6 +1204,11 @@ void CLASS packed_dng_load_raw()
   int row, col;
   int isfloat = (tiff_nifds == 1 && tiff_ifd[0].sample_format == 3 && (tiff_bps == 16 || tiff_bps == 32));
   if (isfloat) {
+    const void *data = tiff_bps == 32 ? RT_map_raw_data (raw_width*raw_height*sizeof *float_raw_image, alignof(float)) : nullptr;
+    if (data) { // RT: read only, see RawImage::loadRaw
+      float_raw_image = (float *) const_cast<void *>(data);
+      return;
+    }
     float_raw_image = new float[raw_width * raw_height];
   }
 
@@ -2448,7 +2478,12 @@ void CLASS unpacked_load_raw()
   int row, col, bits=0;
 
   while (1 << ++bits < maximum);
-  read_shorts (raw_image, raw_width*raw_height);
+  const void *data = load_flags ? nullptr : RT_map_raw_data (raw_width*raw_height*sizeof *raw_image, alignof(ushort));
+  if (data) { // RT: read only, see RawImage::loadRaw
+    free (raw_image);
+    raw_image = (ushort *) const_cast<void *>(data);
+  } else
+    read_shorts (raw_image, raw_width*raw_height);
   if (load_flags) {
       for (row=0; row < raw_height; row++)
         for (col=0; col < raw_width; col++)
@@ -4427,12 +4462,14 @@ void CLASS crop_masked_pixels()
     if (width + left_margin > raw_width) {
       left_margin = raw_width - MIN(width, raw_width);
     }
+    if (!RT_is_mapped (raw_image)) { // RT: else image is filled on demand, see RawImage::get_image
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int row=0; row < height; row++)
       for (int col=0; col < width; col++)
 	BAYER2(row,col) = RAW(row+top_margin,col+left_margin);
+    }
   }
 
   if (mask[0][3] > 0) goto mask_set;
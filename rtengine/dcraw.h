@@ -292,6 +292,8 @@ unsigned getint (int type);
 float int_to_float (int i);
 double getreal (int type);
 void read_shorts (ushort *pixel, int count);
+const void *RT_map_raw_data (size_t size, size_t alignment); // RT
+bool RT_is_mapped (const void *p) const; // RT
 void cubic_spline(const int *x_, const int *y_, const int len);
 void canon_600_fixed_wb (int temp);
 int canon_600_color (int ratio[2], int mar);
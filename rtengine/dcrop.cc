@@ -18,6 +18,8 @@
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <memory>
+
 #include <glibmm/ustring.h>
 #include <glibmm/timer.h>
 
@@ -58,8 +60,8 @@ namespace rtengine
 
 Crop::Crop(ImProcCoordinator* parent, EditDataProvider *editDataProvider, bool isDetailWindow)
     : PipetteBuffer(editDataProvider), origCrop(nullptr), spotCrop(nullptr), laboCrop(nullptr), labnCrop(nullptr),
-      cropImg(nullptr), shbuf_real(nullptr), transCrop(nullptr), cieCrop(nullptr), shbuffer(nullptr),
-      updating(false), newUpdatePending(false), skip(10),
+      shbuf_real(nullptr), transCrop(nullptr), cieCrop(nullptr), shbuffer(nullptr),
+      updating(false), newUpdatePending(false), cancelledTodo(0), cancellable(false), skip(10),
       cropx(0), cropy(0), cropw(-1), croph(-1),
       trafx(0), trafy(0), trafw(-1), trafh(-1),
       rqcropx(0), rqcropy(0), rqcropw(-1), rqcroph(-1),
@@ -150,6 +152,9 @@ void Crop::update(int todo)
     ProcParams& params = *parent->params;
 //       CropGUIListener* cropgl;
 
+    todo |= cancelledTodo;
+    cancelledTodo = 0;
+
     // No need to update todo here, since it has already been changed in ImprocCoordinator::updatePreviewImage,
     // and Crop::update ask to do ALL anyway
 
@@ -945,7 +950,7 @@ void Crop::update(int todo)
         auto& lmasklocal_curve2 = parent->lmasklocal_curve;
         auto& loclmasCurve_wav = parent->loclmasCurve_wav;
 
-        for (int sp = 0; sp < (int)params.locallab.spots.size(); sp++) {
+        for (int sp = 0; sp < (int)params.locallab.spots.size() && !parent->ipf.isCancelled(); sp++) {
             locRETgainCurve.Set(params.locallab.spots.at(sp).localTgaincurve);
             locRETtransCurve.Set(params.locallab.spots.at(sp).localTtranscurve);
             const bool LHutili = loclhCurve.Set(params.locallab.spots.at(sp).LHcurve);
@@ -1687,41 +1692,27 @@ void Crop::update(int todo)
     // all pipette buffer processing should be finished now
     PipetteBuffer::setReady();
 
+    if (parent->ipf.isCancelled()) {
+        // the crop will be updated again with the next change
+        cancelledTodo = todo;
+        return;
+    }
 
 
-    // Computing the preview image, i.e. converting from lab->Monitor color space (soft-proofing disabled) or lab->Output profile->Monitor color space (soft-proofing enabled)
-    parent->ipf.lab2monitorRgb(labnCrop, cropImg);
 
     if (cropImageListener) {
-        // Computing the internal image for analysis, i.e. conversion from lab->Output profile (rtSettings.HistogramWorking disabled) or lab->WCS (rtSettings.HistogramWorking enabled)
-
-        // internal image in output color space for analysis
-        Image8 *cropImgtrue = parent->ipf.lab2rgb(labnCrop, 0, 0, cropw, croph, params.icm);
-
-        int finalW = rqcropw;
-
-        if (cropImg->getWidth() - leftBorder < finalW) {
-            finalW = cropImg->getWidth() - leftBorder;
-        }
+        // Only the requested region is converted, directly into the images handed over to the listener
+        const int finalW = rtengine::min(rqcropw, cropw - leftBorder);
+        const int finalH = rtengine::min(rqcroph, croph - upperBorder);
 
-        int finalH = rqcroph;
+        // Computing the preview image, i.e. converting from lab->Monitor color space (soft-proofing disabled) or lab->Output profile->Monitor color space (soft-proofing enabled)
+        std::unique_ptr<Image8> final(new Image8(finalW, finalH));
+        parent->ipf.lab2monitorRgb(labnCrop, final.get(), leftBorder, upperBorder);
 
-        if (cropImg->getHeight() - upperBorder < finalH) {
-            finalH = cropImg->getHeight() - upperBorder;
-        }
-
-        Image8* final = new Image8(finalW, finalH);
-        Image8* finaltrue = new Image8(finalW, finalH);
-
-        for (int i = 0; i < finalH; i++) {
-            memcpy(final->data + 3 * i * finalW, cropImg->data + 3 * (i + upperBorder)*cropw + 3 * leftBorder, 3 * finalW);
-            memcpy(finaltrue->data + 3 * i * finalW, cropImgtrue->data + 3 * (i + upperBorder)*cropw + 3 * leftBorder, 3 * finalW);
-        }
+        // Computing the internal image for analysis, i.e. conversion from lab->Output profile (rtSettings.HistogramWorking disabled) or lab->WCS (rtSettings.HistogramWorking enabled)
+        std::unique_ptr<Image8> finaltrue(parent->ipf.lab2rgb(labnCrop, leftBorder, upperBorder, finalW, finalH, params.icm));
 
-        cropImageListener->setDetailedCrop(final, finaltrue, params.icm, params.crop, rqcropx, rqcropy, rqcropw, rqcroph, skip);
-        delete final;
-        delete finaltrue;
-        delete cropImgtrue;
+        cropImageListener->setDetailedCrop(std::move(final), std::move(finaltrue), params.icm, params.crop, rqcropx, rqcropy, rqcropw, rqcroph, skip);
     }
 }
 
@@ -1750,11 +1741,6 @@ void Crop::freeAll()
             labnCrop = nullptr;
         }
 
-        if (cropImg) {
-            delete    cropImg;
-            cropImg = nullptr;
-        }
-
         if (cieCrop) {
             delete    cieCrop;
             cieCrop = nullptr;
@@ -1928,12 +1914,6 @@ bool Crop::setCropSizes(int cropX, int cropY, int cropW, int cropH, int skip, bo
 
         labnCrop = new LabImage(cropw, croph);
 
-        if (!cropImg) {
-            cropImg = new Image8;
-        }
-
-        cropImg->allocate(cropw, croph);  // Resizing the buffer (optimization)
-
         //cieCrop is only used in Crop::update, it is destroyed now but will be allocated on first use
         if (cieCrop) {
             delete cieCrop;
@@ -1987,6 +1967,14 @@ bool Crop::tryUpdate()
     if (updating) {
         // tells to the updater thread that a new update is pending
         newUpdatePending = true;
+
+        // and cancels the one in progress if it's this crop's, not the one of the updater thread of the parent
+        MyMutex::MyLock lock(parent->paramsUpdateMutex);
+
+        if (cancellable) {
+            parent->updateCancelled = true;
+        }
+
         // no need for a new thread, the current one will do the job
         needsNewThread = false;
     } else
@@ -2021,14 +2009,40 @@ void Crop::fullUpdate()
         parent->plistener->setProgressState(true);
     }
 
+    // a change of the parameters cancels the update in progress, and is handled by the updater thread
+    // once this one returns; a new request for this crop cancels it too, and is collected below
+    parent->paramsUpdateMutex.lock();
+    parent->cancellable = true;
+    cancellable = true;
+    parent->paramsUpdateMutex.unlock();
+
     // If there are more update request, the following WHILE will collect it
     newUpdatePending = true;
 
     while (newUpdatePending) {
         newUpdatePending = false;
+
+        parent->paramsUpdateMutex.lock();
+        const bool superseded = parent->changeSinceLast & (M_VOID - 1);
+        parent->updateCancelled = false;
+        parent->paramsUpdateMutex.unlock();
+
+        if (superseded) {
+            // left to the updater thread of the parent, which is waiting for this one
+            MyMutex::MyLock cropLock(cropMutex);
+            cancelledTodo = ALL;
+            break;
+        }
+
         update(ALL);
     }
 
+    parent->paramsUpdateMutex.lock();
+    parent->cancellable = false;
+    parent->updateCancelled = false;
+    cancellable = false;
+    parent->paramsUpdateMutex.unlock();
+
     updating = false;  // end of crop update
 
     if (parent->plistener) {
@@ -2044,6 +2058,12 @@ int Crop::get_skip()
     return skip;
 }
 
+int Crop::getCancelledTodo()
+{
+    MyMutex::MyLock lock(cropMutex);
+    return cancelledTodo;
+}
+
 int Crop::getLeftBorder()
 {
     MyMutex::MyLock lock(cropMutex);
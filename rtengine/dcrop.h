@@ -41,7 +41,6 @@ protected:
     Imagefloat*  spotCrop;   // "one chunk" allocation
     LabImage*    laboCrop;   // "one chunk" allocation
     LabImage*    labnCrop;   // "one chunk" allocation
-    Image8*      cropImg;    // "one chunk" allocation ; displayed image in monitor color space, showing the output profile as well (soft-proofing enabled, which then correspond to workimg) or not
     float *      shbuf_real;  // "one chunk" allocation
 
     // --- automatically allocated and deleted when necessary, and only renewed on size changes
@@ -52,6 +51,8 @@ protected:
 
     bool updating;         /// Flag telling if an updater thread is currently processing
     bool newUpdatePending; /// Flag telling the updater thread that a new update is pending
+    int cancelledTodo;     /// Stages of an update cancelled by a newer change, done again by the next update
+    bool cancellable;      /// Flag telling that fullUpdate can be cancelled by a new request, guarded by parent->paramsUpdateMutex
     int skip;
     int cropx, cropy, cropw, croph;         /// size of the detail crop image ('skip' taken into account), with border
     int trafx, trafy, trafw, trafh;         /// the size and position to get from the imagesource that is transformed to the requested crop area
@@ -91,6 +92,7 @@ public:
     void setListener    (DetailedCropListener* il) override;
     void destroy        () override;
     int get_skip();
+    int getCancelledTodo();
     int getLeftBorder();
     int getUpperBorder();
 };
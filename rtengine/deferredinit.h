@@ -0,0 +1,88 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "noncopyable.h"
+
+#include "../rtgui/threadutils.h"
+
+namespace rtengine
+{
+
+/**
+ * Initialization of a store postponed until the store is first used.
+ *
+ * The store registers its initialization with set() at startup, and calls run() before each access.
+ * Only the first call to run() does some work, the following ones only cost an atomic load.
+ */
+class DeferredInit final :
+    public NonCopyable
+{
+public:
+    DeferredInit() :
+        pending(false),
+        runner(std::thread::id())
+    {
+    }
+
+    void set(std::function<void()> function)
+    {
+        MyMutex::MyLock lock(mutex);
+        init = std::move(function);
+        pending = static_cast<bool>(init);
+    }
+
+    void run()
+    {
+        if (!pending || runner == std::this_thread::get_id()) { // the initialization itself may access the store
+            return;
+        }
+
+        MyMutex::MyLock runLock(runMutex); // waits for an initialization running in another thread
+
+        std::function<void()> function;
+
+        {
+            MyMutex::MyLock lock(mutex);
+            function = std::move(init);
+            init = nullptr;
+        }
+
+        // called without holding mutex, the initialization may call set()
+        if (function) {
+            runner = std::this_thread::get_id();
+            function();
+            runner = std::thread::id();
+        }
+
+        MyMutex::MyLock lock(mutex);
+        pending = static_cast<bool>(init);
+    }
+
+private:
+    std::atomic<bool> pending;
+    std::atomic<std::thread::id> runner;
+    MyMutex mutex;    // protects init
+    MyMutex runMutex; // serializes the initializations
+    std::function<void()> init;
+};
+
+}
@@ -17,6 +17,7 @@
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <iostream>
@@ -25,14 +26,22 @@
 #include <sstream>
 
 #include <giomm.h>
+#include <glib/gstdio.h>
+#include <glibmm/checksum.h>
+#include <glibmm/miscutils.h>
 #include <glibmm/ustring.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "dfmanager.h"
 
 #include "imagedata.h"
 #include "jaggedarray.h"
 #include "noncopyable.h"
 #include "pixelsmap.h"
+#include "rawfileindex.h"
 #include "rawimage.h"
 #include "utils.h"
 
@@ -59,10 +68,10 @@ public:
 
 
     dfInfo(const Glib::ustring &name, const std::string &mak, const std::string &mod, int iso, double shut, time_t t)
-        : pathname(name), maker(mak), model(mod), iso(iso), shutter(shut), timestamp(t), ri(nullptr) {}
+        : pathname(name), maker(mak), model(mod), iso(iso), shutter(shut), timestamp(t), ri(nullptr), badPixelsValid(false) {}
 
     dfInfo(const dfInfo &o)
-        : pathname(o.pathname), maker(o.maker), model(o.model), iso(o.iso), shutter(o.shutter), timestamp(o.timestamp), ri(nullptr) {}
+        : pathname(o.pathname), maker(o.maker), model(o.model), iso(o.iso), shutter(o.shutter), timestamp(o.timestamp), ri(nullptr), badPixelsValid(false) {}
     ~dfInfo();
 
     dfInfo &operator =(const dfInfo &o);
@@ -82,9 +91,15 @@ public:
 private:
     rtengine::RawImage* ri; // Dark Frame raw data
     std::vector<rtengine::badPix> badPixels; // Extracted hot pixels
+    bool badPixelsValid;
 
     void updateBadPixelList(const rtengine::RawImage* df);
     void updateRawImage();
+
+    // the hot pixels are cached on disk, so that they can be used without decoding the dark frame(s) again
+    std::string getHotPixelsCacheFile() const;
+    bool loadHotPixels();
+    void saveHotPixels() const;
 };
 
 dfInfo::~dfInfo()
@@ -106,6 +121,9 @@ inline dfInfo& dfInfo::operator = (const dfInfo &o)
             delete ri;
             ri = nullptr;
         }
+
+        badPixels.clear();
+        badPixelsValid = false;
     }
 
     return *this;
@@ -145,21 +163,102 @@ const rtengine::RawImage* dfInfo::getRawImage()
     }
 
     updateRawImage();
-    updateBadPixelList(ri);
+
+    if (!badPixelsValid) {
+        updateBadPixelList(ri);
+        saveHotPixels();
+    }
 
     return ri;
 }
 
 const std::vector<rtengine::badPix>& dfInfo::getHotPixels()
 {
-    if (!ri) {
-        updateRawImage();
-        updateBadPixelList(ri);
+    if (!badPixelsValid && !loadHotPixels()) {
+        getRawImage();
     }
 
     return badPixels;
 }
 
+std::string dfInfo::getHotPixelsCacheFile() const
+{
+    // the cache file depends on the dark frame(s) it has been extracted from
+    std::ostringstream identifier;
+
+    for (const auto& name : pathNames.empty() ? std::list<Glib::ustring>{pathname} : pathNames) {
+        GStatBuf st;
+
+        if (g_stat(name.c_str(), &st) != 0) {
+            return {};
+        }
+
+        identifier << name << ' ' << st.st_mtime << ' ' << st.st_size << '\n';
+    }
+
+    return Glib::build_filename(Options::cacheBaseDir, "darkframes", Glib::Checksum::compute_checksum(Glib::Checksum::CHECKSUM_MD5, identifier.str()) + ".badpixels");
+}
+
+bool dfInfo::loadHotPixels()
+{
+    const std::string cacheFile = getHotPixelsCacheFile();
+
+    if (cacheFile.empty()) {
+        return false;
+    }
+
+    FILE* const file = g_fopen(cacheFile.c_str(), "r");
+
+    if (!file) {
+        return false;
+    }
+
+    badPixels.clear();
+    char line[256];
+
+    while (fgets(line, sizeof(line), file)) {
+        int x, y;
+
+        if (sscanf(line, "%d %d", &x, &y) == 2) {
+            badPixels.emplace_back(x, y);
+        }
+    }
+
+    fclose(file);
+    badPixelsValid = true;
+
+    if (rtengine::settings->verbose) {
+        std::cout << "Loaded " << badPixels.size() << " hot pixels from " << cacheFile << std::endl;
+    }
+
+    return true;
+}
+
+void dfInfo::saveHotPixels() const
+{
+    if (!badPixelsValid) {
+        return;
+    }
+
+    const std::string cacheFile = getHotPixelsCacheFile();
+
+    if (cacheFile.empty() || g_mkdir_with_parents(Glib::path_get_dirname(cacheFile).c_str(), 0755) != 0) {
+        return;
+    }
+
+    FILE* const file = g_fopen(cacheFile.c_str(), "w");
+
+    if (!file) {
+        return;
+    }
+
+    for (const auto& pixel : badPixels) {
+        fprintf(file, "%d %d\n", pixel.x, pixel.y);
+    }
+
+    fclose(file);
+}
+
 /* updateRawImage() load into ri the actual pixel data from pathname if there is a single shot
  * otherwise load each file from the pathNames list and extract a template from the media;
  * the first file is used also for reading all information other than pixels
@@ -189,32 +288,36 @@ void dfInfo::updateRawImage()
             }
 
             int nFiles = 1; // First file data already loaded
+            const std::vector<Glib::ustring> others(++iName, pathNames.cend());
+            const int nOthers = others.size();
 
-            for (++iName; iName != pathNames.end(); ++iName) {
-                rtengine::RawImage temp(*iName);
+            // the other files are decoded in parallel. Each decoding needs a full sized raw image, so only a few of them are done at once
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) num_threads(std::max(1, std::min({nOthers, omp_get_max_threads(), 4}))) reduction(+:nFiles)
+#endif
+
+            for (int i = 0; i < nOthers; ++i) {
+                rtengine::RawImage temp(others[i]);
 
                 if (!temp.loadRaw(true)) {
                     temp.compress_image(0);     //\ TODO would be better working on original, because is temporary
                     nFiles++;
 
-                    if (ri->getSensorType() == rtengine::ST_BAYER || ri->getSensorType() == rtengine::ST_FUJI_XTRANS) {
-                        for (int row = 0; row < H; row++) {
-                            for (int col = 0; col < W; col++) {
-                                acc[row][col] += temp.data[row][col];
-                            }
-                        }
-                    } else {
-                        for (int row = 0; row < H; row++) {
-                            for (int col = 0; col < W; col++) {
-                                acc[row][3 * col + 0] += temp.data[row][3 * col + 0];
-                                acc[row][3 * col + 1] += temp.data[row][3 * col + 1];
-                                acc[row][3 * col + 2] += temp.data[row][3 * col + 2];
-                            }
+#ifdef _OPENMP
+                    #pragma omp critical(dfAccumulate)
+#endif
+                    for (int row = 0; row < H; row++) {
+                        for (int col = 0; col < rSize; col++) {
+                            acc[row][col] += temp.data[row][col];
                         }
                     }
                 }
             }
+
             const float factor = 1.f / nFiles;
+#ifdef _OPENMP
+            #pragma omp parallel for
+#endif
             for (int row = 0; row < H; row++) {
                 for (int col = 0; col < rSize; col++) {
                     ri->data[row][col] = acc[row][col] * factor;
@@ -288,6 +391,8 @@ void dfInfo::updateBadPixelList(const rtengine::RawImage *df)
         }
     }
 
+    badPixelsValid = true;
+
     if (rtengine::settings->verbose) {
         std::cout << "Extracted " << badPixels.size() << " pixels from darkframe:" << df->get_filename().c_str() << std::endl;
     }
@@ -319,6 +424,7 @@ private:
     bpList_t bpList;
     bool initialized;
     Glib::ustring currentPath;
+    RawFileIndex fileIndex{"darkframes.index"};
     dfInfo* addFileInfo(const Glib::ustring &filename, bool pool = true);
     dfInfo* find(const std::string &mak, const std::string &mod, int isospeed, double shut, time_t t);
     int scanBadPixelsFile(const Glib::ustring &filename);
@@ -349,6 +455,7 @@ void rtengine::DFManager::Implementation::init(const Glib::ustring& pathname)
 
     dfList.clear();
     bpList.clear();
+    fileIndex.load(pathname);
 
     for (const auto &name : names) {
         const auto lastdot = name.find_last_of('.');
@@ -368,6 +475,8 @@ void rtengine::DFManager::Implementation::init(const Glib::ustring& pathname)
         } catch(std::exception& e) {}
     }
 
+    fileIndex.save();
+
     // Where multiple shots exist for same group, move filename to list
     for (auto &df : dfList) {
         dfInfo &i = df.second;
@@ -557,35 +666,41 @@ dfInfo* rtengine::DFManager::Implementation::addFileInfo(const Glib::ustring& fi
             return nullptr;
         }
 
-        RawImage ri(filename);
+        if (!pool) {
+            RawImage ri(filename);
 
-        if (ri.loadRaw(false) != 0) { // Read information about shot
-            return nullptr;
-        }
+            if (ri.loadRaw(false) != 0) { // Read information about shot
+                return nullptr;
+            }
 
-        if (!pool) {
             const dfInfo n(filename, "", "", 0, 0, 0);
             auto iter = dfList.emplace("", n);
             return &(iter->second);
         }
 
-        FramesData idata(filename, std::unique_ptr<RawMetaDataLocation>(new RawMetaDataLocation(ri.get_exifBase(), ri.get_ciffBase(), ri.get_ciffLen())), true);
+        // Read information about shot, from the index if the file didn't change
+        const RawFileIndex::ShotInfo* const shot = fileIndex.get(filename);
+
+        if (!shot) {
+            return nullptr;
+        }
+
         /* Files are added in the map, divided by same maker/model,ISO and shutter*/
-        std::string key(dfInfo::key(toUppercase(idata.getMake()), toUppercase(idata.getModel()), idata.getISOSpeed(), idata.getShutterSpeed()));
+        std::string key(dfInfo::key(toUppercase(shot->make), toUppercase(shot->model), shot->iso, shot->shutter));
         auto iter = dfList.find(key);
 
         if (iter == dfList.end()) {
-            dfInfo n(filename, toUppercase(idata.getMake()), toUppercase(idata.getModel()), idata.getISOSpeed(), idata.getShutterSpeed(), idata.getDateTimeAsTS());
+            dfInfo n(filename, toUppercase(shot->make), toUppercase(shot->model), shot->iso, shot->shutter, shot->timestamp);
             iter = dfList.emplace(key, n);
         } else {
-            while(iter != dfList.end() && iter->second.key() == key && ABS(iter->second.timestamp - idata.getDateTimeAsTS()) > 60 * 60 * 6) { // 6 hour difference
+            while(iter != dfList.end() && iter->second.key() == key && ABS(iter->second.timestamp - shot->timestamp) > 60 * 60 * 6) { // 6 hour difference
                 ++iter;
             }
 
             if (iter != dfList.end()) {
                 iter->second.pathNames.push_back(filename);
             } else {
-                dfInfo n(filename, toUppercase(idata.getMake()), toUppercase(idata.getModel()), idata.getISOSpeed(), idata.getShutterSpeed(), idata.getDateTimeAsTS());
+                dfInfo n(filename, toUppercase(shot->make), toUppercase(shot->model), shot->iso, shot->shutter, shot->timestamp);
                 iter = dfList.emplace(key, n);
             }
         }
@@ -693,14 +808,25 @@ int rtengine::DFManager::Implementation::scanBadPixelsFile(const Glib::ustring&
 rtengine::DFManager& rtengine::DFManager::getInstance()
 {
     static DFManager instance;
+    instance.deferredInit.run();
     return instance;
 }
 
 void rtengine::DFManager::init(const Glib::ustring& pathname)
 {
+    // an explicit initialization replaces the deferred one
+    deferredInit.set(nullptr);
+
     implementation->init(pathname);
 }
 
+void rtengine::DFManager::initDeferred(const Glib::ustring& pathname)
+{
+    deferredInit.set([this, pathname]() {
+        init(pathname);
+    });
+}
+
 Glib::ustring rtengine::DFManager::getPathname() const
 {
     return implementation->getPathname();
@@ -24,6 +24,8 @@
 
 #include <glibmm/ustring.h>
 
+#include "deferredinit.h"
+
 namespace rtengine
 {
 
@@ -37,6 +39,8 @@ public:
     static DFManager& getInstance();
 
     void init(const Glib::ustring& pathname);
+    /** Same as init(), but the folder is only read when the manager is first used */
+    void initDeferred(const Glib::ustring& pathname);
     Glib::ustring getPathname() const;
     void getStat(int& totFiles, int& totTemplates) const;
     const RawImage* searchDarkFrame(const std::string& mak, const std::string& mod, int iso, double shut, time_t t);
@@ -52,6 +56,7 @@ private:
     class Implementation;
 
     const std::unique_ptr<Implementation> implementation;
+    DeferredInit deferredInit;
 };
 
 }
@@ -17,9 +17,16 @@
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <giomm/file.h>
 #include <glibmm/miscutils.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ffmanager.h"
 #include "../rtgui/options.h"
 #include "rawimage.h"
@@ -159,32 +166,30 @@ void ffInfo::updateRawImage()
                 }
 
             int nFiles = 1; // First file data already loaded
+            const std::vector<Glib::ustring> others(++iName, pathNames.end());
+            const int nOthers = others.size();
 
-            for( ++iName; iName != pathNames.end(); ++iName) {
-                RawImage* temp = new RawImage(*iName);
+            // the other files are decoded in parallel. Each decoding needs a full sized raw image, so only a few of them are done at once
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) num_threads(std::max(1, std::min({nOthers, omp_get_max_threads(), 4}))) reduction(+:nFiles)
+#endif
 
-                if( !temp->loadRaw(true)) {
-                    temp->compress_image(0);     //\ TODO would be better working on original, because is temporary
+            for (int i = 0; i < nOthers; ++i) {
+                RawImage temp(others[i]);
+
+                if( !temp.loadRaw(true)) {
+                    temp.compress_image(0);     //\ TODO would be better working on original, because is temporary
                     nFiles++;
 
-                    if( ri->getSensorType() == ST_BAYER || ri->getSensorType() == ST_FUJI_XTRANS || ri->get_colors() == 1 ) {
-                        for( int row = 0; row < H; row++) {
-                            for( int col = 0; col < W; col++) {
-                                acc[row][col] += temp->data[row][col];
-                            }
-                        }
-                    } else {
-                        for( int row = 0; row < H; row++) {
-                            for( int col = 0; col < W; col++) {
-                                acc[row][3 * col + 0] += temp->data[row][3 * col + 0];
-                                acc[row][3 * col + 1] += temp->data[row][3 * col + 1];
-                                acc[row][3 * col + 2] += temp->data[row][3 * col + 2];
-                            }
+#ifdef _OPENMP
+                    #pragma omp critical(ffAccumulate)
+#endif
+                    for( int row = 0; row < H; row++) {
+                        for( int col = 0; col < rSize; col++) {
+                            acc[row][col] += temp.data[row][col];
                         }
                     }
                 }
-
-                delete temp;
             }
 
             for (int row = 0; row < H; row++) {
@@ -240,6 +245,9 @@ void ffInfo::updateRawImage()
 
 void FFManager::init(const Glib::ustring& pathname)
 {
+    // an explicit initialization replaces the deferred one
+    deferredInit.set(nullptr);
+
     if (pathname.empty()) {
         return;
     }
@@ -262,6 +270,7 @@ void FFManager::init(const Glib::ustring& pathname)
     } catch (Glib::Exception&) {}
 
     ffList.clear();
+    fileIndex.load(pathname);
 
     for (size_t i = 0; i < names.size(); i++) {
         try {
@@ -269,6 +278,8 @@ void FFManager::init(const Glib::ustring& pathname)
         } catch( std::exception& e ) {}
     }
 
+    fileIndex.save();
+
     // Where multiple shots exist for same group, move filename to list
     for( ffList_t::iterator iter = ffList.begin(); iter != ffList.end(); ++iter ) {
         ffInfo &i = iter->second;
@@ -327,38 +338,44 @@ ffInfo* FFManager::addFileInfo (const Glib::ustring& filename, bool pool)
             return nullptr;
         }
 
-        RawImage ri(filename);
-        int res = ri.loadRaw(false); // Read information about shot
-
-        if (res != 0) {
-            return nullptr;
-        }
-
         ffList_t::iterator iter;
 
         if(!pool) {
+            RawImage ri(filename);
+            int res = ri.loadRaw(false); // Read information about shot
+
+            if (res != 0) {
+                return nullptr;
+            }
+
             ffInfo n(filename, "", "", "", 0, 0, 0);
             iter = ffList.emplace("", n);
             return &(iter->second);
         }
 
-        FramesData idata(filename, std::unique_ptr<RawMetaDataLocation>(new RawMetaDataLocation(ri.get_exifBase(), ri.get_ciffBase(), ri.get_ciffLen())), true);
+        // Read information about shot, from the index if the file didn't change
+        const RawFileIndex::ShotInfo* const shot = fileIndex.get(filename);
+
+        if (!shot) {
+            return nullptr;
+        }
+
         /* Files are added in the map, divided by same maker/model,lens and aperture*/
-        std::string key(ffInfo::key(idata.getMake(), idata.getModel(), idata.getLens(), idata.getFocalLen(), idata.getFNumber()));
+        std::string key(ffInfo::key(shot->make, shot->model, shot->lens, shot->focalLength, shot->fnumber));
         iter = ffList.find(key);
 
         if(iter == ffList.end()) {
-            ffInfo n(filename, idata.getMake(), idata.getModel(), idata.getLens(), idata.getFocalLen(), idata.getFNumber(), idata.getDateTimeAsTS());
+            ffInfo n(filename, shot->make, shot->model, shot->lens, shot->focalLength, shot->fnumber, shot->timestamp);
             iter = ffList.emplace(key, n);
         } else {
-            while(iter != ffList.end() && iter->second.key() == key && ABS(iter->second.timestamp - ri.get_timestamp()) > 60 * 60 * 6) { // 6 hour difference
+            while(iter != ffList.end() && iter->second.key() == key && ABS(iter->second.timestamp - shot->rawTimestamp) > 60 * 60 * 6) { // 6 hour difference
                 ++iter;
             }
 
             if(iter != ffList.end()) {
                 iter->second.pathNames.push_back(filename);
             } else {
-                ffInfo n(filename, idata.getMake(), idata.getModel(), idata.getLens(), idata.getFocalLen(), idata.getFNumber(), idata.getDateTimeAsTS());
+                ffInfo n(filename, shot->make, shot->model, shot->lens, shot->focalLength, shot->fnumber, shot->timestamp);
                 iter = ffList.emplace(key, n);
             }
         }
@@ -370,8 +387,17 @@ ffInfo* FFManager::addFileInfo (const Glib::ustring& filename, bool pool)
     return nullptr;
 }
 
+void FFManager::initDeferred(const Glib::ustring& pathname)
+{
+    deferredInit.set([this, pathname]() {
+        init(pathname);
+    });
+}
+
 void FFManager::getStat( int &totFiles, int &totTemplates)
 {
+    deferredInit.run();
+
     totFiles = 0;
     totTemplates = 0;
 
@@ -434,6 +460,8 @@ ffInfo* FFManager::find( const std::string &mak, const std::string &mod, const s
 
 RawImage* FFManager::searchFlatField( const std::string &mak, const std::string &mod, const std::string &len, double focal, double apert, time_t t )
 {
+    deferredInit.run();
+
     ffInfo *ff = find( mak, mod, len, focal, apert, t );
 
     if( ff ) {
@@ -445,6 +473,8 @@ RawImage* FFManager::searchFlatField( const std::string &mak, const std::string
 
 RawImage* FFManager::searchFlatField( const Glib::ustring filename )
 {
+    deferredInit.run();
+
     for ( ffList_t::iterator iter = ffList.begin(); iter != ffList.end(); ++iter ) {
         if( iter->second.pathname.compare( filename ) == 0  ) {
             return iter->second.getRawImage();
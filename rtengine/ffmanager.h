@@ -25,6 +25,9 @@
 
 #include <glibmm/ustring.h>
 
+#include "deferredinit.h"
+#include "rawfileindex.h"
+
 namespace rtengine
 {
 
@@ -75,8 +78,11 @@ class FFManager final
 {
 public:
     void init(const Glib::ustring &pathname);
+    /** Same as init(), but the folder is only read when the manager is first used */
+    void initDeferred(const Glib::ustring &pathname);
     Glib::ustring getPathname()
     {
+        deferredInit.run();
         return currentPath;
     };
     void getStat( int &totFiles, int &totTemplate);
@@ -88,6 +94,8 @@ protected:
     ffList_t ffList;
     bool initialized;
     Glib::ustring currentPath;
+    RawFileIndex fileIndex{"flatfields.index"};
+    DeferredInit deferredInit;
     ffInfo *addFileInfo(const Glib::ustring &filename, bool pool = true );
     ffInfo *find( const std::string &mak, const std::string &mod, const std::string &len, double focal, double apert, time_t t );
 };
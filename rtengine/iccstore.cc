@@ -18,6 +18,8 @@
  */
 #include <cstring>
 #include <map>
+#include <tuple>
+#include <utility>
 
 #include <glibmm/ustring.h>
 #include <glibmm/fileutils.h>
@@ -35,6 +37,8 @@
 #include "iccstore.h"
 
 #include "iccmatrices.h"
+#include "linalgebra.h"
+#include "rtengine.h"
 #include "utils.h"
 
 #include "../rtgui/options.h"
@@ -289,6 +293,71 @@ Glib::ustring get_profile_description(cmsHPROFILE profile)
     return std::string(&buf[0]);
 }
 
+// Must be called with lcmsMutex held
+std::shared_ptr<const rtengine::MatrixShaper> buildMatrixShaper(cmsHPROFILE profile, cmsUInt32Number intent)
+{
+    if (!profile || intent == INTENT_ABSOLUTE_COLORIMETRIC || cmsGetColorSpace(profile) != cmsSigRgbData || cmsGetPCS(profile) != cmsSigXYZData || !cmsIsMatrixShaper(profile)) {
+        return nullptr;
+    }
+
+    // LCMS prefers the B2A tables of the intent over the matrix and tone curves when a profile has both
+    if (cmsIsCLUT(profile, intent, LCMS_USED_AS_OUTPUT)) {
+        return nullptr;
+    }
+
+    const cmsTagSignature colorantTags[3] = {cmsSigRedColorantTag, cmsSigGreenColorantTag, cmsSigBlueColorantTag};
+    const cmsTagSignature trcTags[3] = {cmsSigRedTRCTag, cmsSigGreenTRCTag, cmsSigBlueTRCTag};
+
+    double rgbToXyz[3][3];
+    const cmsToneCurve* trcs[3];
+
+    for (int c = 0; c < 3; ++c) {
+        const cmsCIEXYZ* const colorant = static_cast<const cmsCIEXYZ*>(cmsReadTag(profile, colorantTags[c]));
+        trcs[c] = static_cast<const cmsToneCurve*>(cmsReadTag(profile, trcTags[c]));
+
+        // black has to map to 0, otherwise black point compensation would not be a no-op
+        if (!colorant || !trcs[c] || cmsEvalToneCurveFloat(trcs[c], 0.f) > 1e-6f) {
+            return nullptr;
+        }
+
+        rgbToXyz[0][c] = colorant->X;
+        rgbToXyz[1][c] = colorant->Y;
+        rgbToXyz[2][c] = colorant->Z;
+    }
+
+    rtengine::Mat33<double> xyzToRgb;
+
+    if (!rtengine::inverse(rgbToXyz, xyzToRgb)) {
+        return nullptr;
+    }
+
+    const std::shared_ptr<rtengine::MatrixShaper> shaper = std::make_shared<rtengine::MatrixShaper>();
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            shaper->xyzToRgb[i][j] = xyzToRgb[i][j];
+        }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        cmsToneCurve* const reversed = cmsReverseToneCurve(trcs[c]);
+
+        if (!reversed) {
+            return nullptr;
+        }
+
+        shaper->trc[c](65536, LUT_CLIP_BELOW | LUT_CLIP_ABOVE);
+
+        for (int i = 0; i < 65536; ++i) {
+            shaper->trc[c][i] = 65535.f * cmsEvalToneCurveFloat(reversed, i / 65535.f);
+        }
+
+        cmsFreeToneCurve(reversed);
+    }
+
+    return shaper;
+}
+
 } // namespace
 
 
@@ -396,7 +465,9 @@ public:
     Implementation() :
         loadAll(true),
         xyz(createXYZProfile()),
-        srgb(cmsCreate_sRGBProfile())
+        srgb(cmsCreate_sRGBProfile()),
+        lab(cmsCreateLab4Profile(nullptr)),
+        transformUses(0)
     {
         //cmsErrorAction(LCMS_ERROR_SHOW);
 
@@ -436,6 +507,10 @@ public:
         if (xyz) {
             cmsCloseProfile(xyz);
         }
+
+        if (lab) {
+            cmsCloseProfile(lab);
+        }
     }
 
     void init(const Glib::ustring& usrICCDir, const Glib::ustring& rtICCDir, bool loadAll)
@@ -446,6 +521,12 @@ public:
 
         this->loadAll = loadAll;
 
+        {
+            MyMutex::MyLock transformLock(transformMutex);
+            transforms.clear();
+            matrixShapers.clear();
+        }
+
         // RawTherapee's profiles take precedence if a user's profile of the same name exists
         profilesDir = Glib::build_filename(rtICCDir, "output");
         userICCDir = usrICCDir;
@@ -632,6 +713,93 @@ public:
         return srgb;
     }
 
+    cmsHPROFILE getLabProfile() const
+    {
+        return lab;
+    }
+
+    std::shared_ptr<void> getTransform(cmsHPROFILE in, cmsUInt32Number inFormat, cmsHPROFILE out, cmsUInt32Number outFormat, cmsUInt32Number intent, cmsUInt32Number flags)
+    {
+        const TransformKey key{in, inFormat, out, outFormat, intent, flags};
+
+        {
+            MyMutex::MyLock lock(transformMutex);
+
+            const TransformMap::iterator iter = transforms.find(key);
+
+            if (iter != transforms.end()) {
+                iter->second.lastUse = ++transformUses;
+                return iter->second.transform;
+            }
+        }
+
+        // the transform is created without holding transformMutex, so that cache hits never wait for lcmsMutex
+        cmsHTRANSFORM hTransform;
+
+        {
+            MyMutex::MyLock lcmsLock(*lcmsMutex);
+            hTransform = cmsCreateTransform(in, inFormat, out, outFormat, intent, flags);
+        }
+
+        if (!hTransform) {
+            return nullptr;
+        }
+
+        const std::shared_ptr<void> transform(hTransform, cmsDeleteTransform);
+
+        MyMutex::MyLock lock(transformMutex);
+
+        const TransformMap::iterator iter = transforms.find(key);
+
+        if (iter != transforms.end()) {
+            // another thread has been faster
+            iter->second.lastUse = ++transformUses;
+            return iter->second.transform;
+        }
+
+        if (transforms.size() >= maxTransforms) {
+            // forget the least recently used transform, users still holding it keep it alive
+            TransformMap::iterator oldest = transforms.begin();
+
+            for (TransformMap::iterator t = transforms.begin(); t != transforms.end(); ++t) {
+                if (t->second.lastUse < oldest->second.lastUse) {
+                    oldest = t;
+                }
+            }
+
+            transforms.erase(oldest);
+        }
+
+        transforms[key] = {transform, ++transformUses};
+        return transform;
+    }
+
+    std::shared_ptr<const MatrixShaper> getMatrixShaper(cmsHPROFILE profile, cmsUInt32Number intent)
+    {
+        const MatrixShaperKey key(profile, intent);
+
+        {
+            MyMutex::MyLock lock(transformMutex);
+
+            const MatrixShaperMap::const_iterator iter = matrixShapers.find(key);
+
+            if (iter != matrixShapers.end()) {
+                return iter->second;
+            }
+        }
+
+        std::shared_ptr<const MatrixShaper> shaper;
+
+        {
+            MyMutex::MyLock lcmsLock(*lcmsMutex);
+            shaper = buildMatrixShaper(profile, intent);
+        }
+
+        // unsuitable profiles are remembered too, so that they are checked only once per intent
+        MyMutex::MyLock lock(transformMutex);
+        return matrixShapers.emplace(key, shaper).first->second;
+    }
+
     std::vector<Glib::ustring> getProfiles(ProfileType type) const
     {
         std::vector<Glib::ustring> res;
@@ -1025,8 +1193,40 @@ parse_error:
 
     const cmsHPROFILE xyz;
     const cmsHPROFILE srgb;
+    const cmsHPROFILE lab;
 
     mutable MyMutex mutex;
+
+    struct TransformKey {
+        cmsHPROFILE in;
+        cmsUInt32Number inFormat;
+        cmsHPROFILE out;
+        cmsUInt32Number outFormat;
+        cmsUInt32Number intent;
+        cmsUInt32Number flags;
+
+        bool operator <(const TransformKey& other) const
+        {
+            return std::tie(in, inFormat, out, outFormat, intent, flags) < std::tie(other.in, other.inFormat, other.out, other.outFormat, other.intent, other.flags);
+        }
+    };
+
+    struct CachedTransform {
+        std::shared_ptr<void> transform;
+        unsigned long lastUse;
+    };
+
+    using TransformMap = std::map<TransformKey, CachedTransform>;
+
+    static constexpr std::size_t maxTransforms = 32;
+
+    using MatrixShaperKey = std::pair<cmsHPROFILE, cmsUInt32Number>;
+    using MatrixShaperMap = std::map<MatrixShaperKey, std::shared_ptr<const MatrixShaper>>;
+
+    TransformMap transforms;
+    MatrixShaperMap matrixShapers;
+    unsigned long transformUses;
+    MyMutex transformMutex;
 };
 
 rtengine::ICCStore* rtengine::ICCStore::getInstance()
@@ -1102,6 +1302,21 @@ cmsHPROFILE rtengine::ICCStore::getsRGBProfile() const
     return implementation->getsRGBProfile();
 }
 
+cmsHPROFILE rtengine::ICCStore::getLabProfile() const
+{
+    return implementation->getLabProfile();
+}
+
+std::shared_ptr<void> rtengine::ICCStore::getTransform(cmsHPROFILE in, cmsUInt32Number inFormat, cmsHPROFILE out, cmsUInt32Number outFormat, cmsUInt32Number intent, cmsUInt32Number flags)
+{
+    return implementation->getTransform(in, inFormat, out, outFormat, intent, flags);
+}
+
+std::shared_ptr<const rtengine::MatrixShaper> rtengine::ICCStore::getMatrixShaper(cmsHPROFILE profile, cmsUInt32Number intent)
+{
+    return implementation->getMatrixShaper(profile, intent);
+}
+
 std::vector<Glib::ustring> rtengine::ICCStore::getProfiles(ProfileType type) const
 {
     return implementation->getProfiles(type);
@@ -27,6 +27,8 @@
 
 #include <lcms2.h>
 
+#include "LUT.h"
+
 namespace rtengine
 {
 
@@ -54,6 +56,15 @@ private:
     std::string data;
 };
 
+/**
+ * Matrix and tone curves of a matrix-shaper RGB profile, which are all that is needed to convert
+ * from XYZ (D50, Y of white = 65535) to the profile without going through LCMS.
+ */
+struct MatrixShaper {
+    double xyzToRgb[3][3]; ///< XYZ to linear RGB of the profile
+    LUTf trc[3];           ///< linear RGB to encoded RGB, both in [0;65535] and clipped
+};
+
 class ICCStore final
 {
 public:
@@ -82,6 +93,23 @@ public:
 
     cmsHPROFILE      getXYZProfile() const;
     cmsHPROFILE      getsRGBProfile() const;
+    cmsHPROFILE      getLabProfile() const;
+
+    /**
+     * Returns a transform between two profiles owned by the store, creating it only on first request.
+     * The transform is shared by all the callers asking for the same profiles, formats, intent and flags,
+     * so it has to be created with cmsFLAGS_NOCACHE to be usable from several threads at once.
+     * The cache only keeps the most recently used transforms; the returned pointer keeps its transform alive.
+     */
+    std::shared_ptr<void> getTransform(cmsHPROFILE in, cmsUInt32Number inFormat, cmsHPROFILE out, cmsUInt32Number outFormat, cmsUInt32Number intent, cmsUInt32Number flags);
+    /**
+     * Returns the matrix and tone curves of a profile owned by the store, or nullptr if the profile isn't a plain
+     * matrix-shaper RGB profile, if it has B2A tables for intent (which LCMS would use instead) or if intent is
+     * absolute colorimetric. The result matches a transform from Lab with this intent, with or without black point
+     * compensation (a no-op for these profiles), within the precision of the sampled inverse tone curves: about one
+     * 8-bit output level near black, where the curves are steepest.
+     */
+    std::shared_ptr<const MatrixShaper> getMatrixShaper(cmsHPROFILE profile, cmsUInt32Number intent);
 
     std::vector<Glib::ustring> getProfiles(ProfileType type = ProfileType::MONITOR) const;
     std::vector<Glib::ustring> getProfilesFromDir(const Glib::ustring& dirName) const;
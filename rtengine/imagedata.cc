@@ -1390,6 +1390,7 @@ FramesData::FramesData(const Glib::ustring& fname, std::unique_ptr<RawMetaDataLo
 
         if (f) {
             rtexif::ExifManager exifManager(f, std::move(rml), firstFrameOnly);
+            exifManager.setMapped(true);
             if (exifManager.f && exifManager.rml) {
                 if (exifManager.rml->exifBase >= 0) {
                     exifManager.parseRaw ();
@@ -1443,6 +1444,7 @@ FramesData::FramesData(const Glib::ustring& fname, std::unique_ptr<RawMetaDataLo
 
         if (f) {
             rtexif::ExifManager exifManager(f, std::move(rml), firstFrameOnly);
+            exifManager.setMapped(true);
 
             exifManager.parseTIFF();
             roots = exifManager.roots;
@@ -16,6 +16,7 @@
  *  You should have received a copy of the GNU General Public License
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <fstream>
 
 #include <glibmm/thread.h>
@@ -76,6 +77,7 @@ ImProcCoordinator::ImProcCoordinator() :
     sharpMask(false),
     sharpMaskChanged(false),
     scale(10),
+    coarsePreview(false),
     highDetailPreprocessComputed(false),
     highDetailRawComputed(false),
     allocated(false),
@@ -177,6 +179,8 @@ ImProcCoordinator::ImProcCoordinator() :
     thread(nullptr),
     changeSinceLast(0),
     updaterRunning(false),
+    cancellable(false),
+    updateCancelled(false),
     nextParams(new procparams::ProcParams),
     destroying(false),
     utili(false),
@@ -244,6 +248,7 @@ ImProcCoordinator::ImProcCoordinator() :
     locallcieMask(0),
     retistrsav(nullptr)
 {
+    ipf.setCancellation(&updateCancelled);
 }
 
 ImProcCoordinator::~ImProcCoordinator()
@@ -327,12 +332,39 @@ DetailedCrop* ImProcCoordinator::createCrop(::EditDataProvider *editDataProvider
 
 
 // todo: bitmask containing desired actions, taken from changesSinceLast
-void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
+void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange, bool coarse)
 {
     // TODO Locallab printf
 
     MyMutex::MyLock processingLock(mProcessing);
 
+    // Called at the boundaries of the heavy stages: the buffers of a cancelled update are left incomplete,
+    // the change is handled again by the next update
+    const auto cancelled =
+        [this]() -> bool
+        {
+            if (!ipf.isCancelled()) {
+                return false;
+            }
+
+            if (orig_prev != oprevi) {
+                delete oprevi;
+                oprevi = nullptr;
+            }
+
+            return true;
+        };
+
+    // The crops only have to handle the actual change, but the preview has to be computed again
+    // from the start when switching between the coarse and the regular scale
+    int cropTodo = todo;
+    const bool cropPanningRelatedChange = panningRelatedChange;
+
+    if (coarse != coarsePreview) {
+        todo |= ALLNORAW;
+        panningRelatedChange = true;
+    }
+
     bool highDetailNeeded = options.prevdemo == PD_Sidecar ? true : (todo & M_HIGHQUAL);
                 //    printf("metwb=%s \n", params->wb.method.c_str());
 
@@ -349,8 +381,9 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
     if (((todo & ALL) == ALL) || (todo & M_MONITOR) || panningRelatedChange || (highDetailNeeded && options.prevdemo != PD_Sidecar)) {
         bwAutoR = bwAutoG = bwAutoB = -9000.f;
 
-        if (todo == CROP && ipf.needsPCVignetting()) {
+        if (cropTodo == CROP && ipf.needsPCVignetting()) {
             todo |= TRANSFORM;    // Change about Crop does affect TRANSFORM
+            cropTodo |= TRANSFORM;
         }
 
         RAWParams rp = params->raw;
@@ -449,6 +482,7 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
 
             // if a demosaic happened we should also call getimage later, so we need to set the M_INIT flag
             todo |= (M_INIT | M_CSHARP);
+            cropTodo |= (M_INIT | M_CSHARP);
 
         }
 
@@ -628,7 +662,7 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
             imgsrc->getFullSize(fw, fh, tr);
 
             // Will (re)allocate the preview's buffers
-            setScale(scale);
+            setScale(coarsePreview ? scale / coarsePreviewFactor : scale, coarse);
             PreviewProps pp(0, 0, fw, fh, scale);
             // Tells to the ImProcFunctions' tools what is the preview scale, which may lead to some simplifications
             ipf.setScale(scale);
@@ -712,6 +746,11 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
 
         oprevi = orig_prev;
 
+        // the denoise stage may have been cancelled, whether the HDR tools run or not
+        if (cancelled()) {
+            return;
+        }
+
         if ((todo & M_SPOT) && !spotsDone) {
             if (params->spot.enabled && !params->spot.entries.empty()) {
                 allocCache(spotprev);
@@ -741,6 +780,10 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
             if (oprevi != orig_prev) {
                 delete oprevi;
             }
+
+            if (cancelled()) {
+                return;
+            }
         }
 
         // Remove transformation if unneeded
@@ -1001,7 +1044,7 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
             float *fabrefp = nullptr;
             fabrefp = new float[sizespot];
 
-            for (int sp = 0; sp < (int)params->locallab.spots.size(); sp++) {
+            for (int sp = 0; sp < (int)params->locallab.spots.size() && !ipf.isCancelled(); sp++) {
 
                 if (params->locallab.spots.at(sp).equiltm  && params->locallab.spots.at(sp).exptonemap) {
                     savenormtm.reset(new LabImage(*oprevl, true));
@@ -1356,6 +1399,9 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
             // end locallab
             //*************************************************************
             
+            if (cancelled()) {
+                return;
+            }
         }
         
         if ((todo & M_RGBCURVE) || (todo & M_CROP)) {
@@ -1887,6 +1933,10 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
                 }
             }
 
+            if (cancelled()) {
+                return;
+            }
+
             if (params->colorappearance.enabled) {
                 // L histo  and Chroma histo for ciecam
                 // histogram will be for Lab (Lch) values, because very difficult to do with J,Q, M, s, C
@@ -2044,10 +2094,10 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
         }
     }
 
-// process crop, if needed
-    for (size_t i = 0; i < crops.size(); i++)
-        if (crops[i]->hasListener() && (panningRelatedChange || (highDetailNeeded && options.prevdemo != PD_Sidecar) || (todo & (M_MONITOR | M_RGBCURVE | M_LUMACURVE)) || crops[i]->get_skip() == 1)) {
-            crops[i]->update(todo);     // may call ourselves
+// process crop, if needed (not for a coarse preview, the crops are updated when it is refined)
+    for (size_t i = 0; i < crops.size() && !coarse && !ipf.isCancelled(); i++)
+        if (crops[i]->hasListener() && (cropPanningRelatedChange || (highDetailNeeded && options.prevdemo != PD_Sidecar) || (cropTodo & (M_MONITOR | M_RGBCURVE | M_LUMACURVE)) || crops[i]->get_skip() == 1 || crops[i]->getCancelledTodo())) {
+            crops[i]->update(cropTodo);     // may call ourselves
         }
 
     if (panningRelatedChange || (todo & M_MONITOR)) {
@@ -2084,18 +2134,8 @@ void ImProcCoordinator::updatePreviewImage(int todo, bool panningRelatedChange)
 
         hist_lrgb_dirty = vectorscope_hc_dirty = vectorscope_hs_dirty = waveform_dirty = true;
         if (hListener) {
-            if (hListener->updateHistogram()) {
-                updateLRGBHistograms();
-            }
-            if (hListener->updateVectorscopeHC()) {
-                updateVectorscopeHC();
-            }
-            if (hListener->updateVectorscopeHS()) {
-                updateVectorscopeHS();
-            }
-            if (hListener->updateWaveform()) {
-                updateWaveforms();
-            }
+            // scopes whose panels are hidden are computed when they are shown
+            updateScopes(hListener->updateHistogram(), hListener->updateVectorscopeHC(), hListener->updateVectorscopeHS(), hListener->updateWaveform());
             notifyHistogramChanged();
         }
     }
@@ -2175,8 +2215,9 @@ void ImProcCoordinator::allocCache (Imagefloat* &imgfloat)
  * It will then tell to the SizeListener that size has changed (sizeChanged)
  *
  * @param prevscale New Preview's scale.
+ * @param coarse Use coarsePreviewFactor times the resulting scale, for the first pass of a progressive update
  */
-void ImProcCoordinator::setScale(int prevscale)
+void ImProcCoordinator::setScale(int prevscale, bool coarse)
 {
 
     tr = getCoarseBitMask(params->coarse);
@@ -2192,6 +2233,12 @@ void ImProcCoordinator::setScale(int prevscale)
         imgsrc->getSize (pp, nW, nH);
     } while (nH < 400 && prevscale > 1 && (nW * nH < 1000000));  // actually hardcoded values, perhaps a better choice is possible
 
+    if (coarse) {
+        prevscale *= coarsePreviewFactor;
+        PreviewProps pp (0, 0, fw, fh, prevscale);
+        imgsrc->getSize (pp, nW, nH);
+    }
+
     if (nW != pW || nH != pH) {
 
         freeAll();
@@ -2212,6 +2259,7 @@ void ImProcCoordinator::setScale(int prevscale)
     }
 
     scale = prevscale;
+    coarsePreview = coarse;
     resultValid = false;
     fullw = fw;
     fullh = fh;
@@ -2223,6 +2271,23 @@ void ImProcCoordinator::setScale(int prevscale)
 }
 
 
+/** @brief Tells whether a change is worth showing a coarse preview first
+ * Only the tools whose cost dominates the preview pipeline are considered, the raw stages don't depend on the
+ * preview scale anyway. The tools get the preview scale, so their radii follow the coarse scale.
+ */
+bool ImProcCoordinator::needsProgressivePreview(int todo, bool panningRelatedChange) const
+{
+    if (!options.progressivePreview || !panningRelatedChange || (todo & (M_PREPROC | M_RAW))) {
+        return false;
+    }
+
+    return
+        params->wavelet.enabled
+        || (params->locallab.enabled && !params->locallab.spots.empty())
+        || params->colorappearance.enabled
+        || params->fattal.enabled;
+}
+
 void ImProcCoordinator::notifyHistogramChanged()
 {
     if (hListener) {
@@ -2255,219 +2320,230 @@ void ImProcCoordinator::notifyHistogramChanged()
 
 bool ImProcCoordinator::updateLRGBHistograms()
 {
+    return updateScopes(true, false, false, false);
+}
 
-    if (!hist_lrgb_dirty) {
-        return false;
-    }
-
-    int x1, y1, x2, y2;
-    params->crop.mapToResized(pW, pH, scale, x1, x2, y1, y2);
-
-#ifdef _OPENMP
-    #pragma omp parallel sections
-#endif
-    {
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-        {
-            histChroma.clear();
-
-            for (int i = y1; i < y2; i++)
-                for (int j = x1; j < x2; j++)
-                {
-                    histChroma[(int)(sqrtf(SQR(nprevl->a[i][j]) + SQR(nprevl->b[i][j])) / 188.f)]++;      //188 = 48000/256
-                }
-        }
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-        {
-            histLuma.clear();
-
-            for (int i = y1; i < y2; i++)
-                for (int j = x1; j < x2; j++)
-                {
-                    histLuma[(int)(nprevl->L[i][j] / 128.f)]++;
-                }
-        }
-#ifdef _OPENMP
-        #pragma omp section
-#endif
-        {
-            histRed.clear();
-            histGreen.clear();
-            histBlue.clear();
-
-            for (int i = y1; i < y2; i++)
-            {
-                int ofs = (i * pW + x1) * 3;
+bool ImProcCoordinator::updateVectorscopeHC()
+{
+    return updateScopes(false, true, false, false);
+}
 
-                for (int j = x1; j < x2; j++) {
-                    int r = workimg->data[ofs++];
-                    int g = workimg->data[ofs++];
-                    int b = workimg->data[ofs++];
+bool ImProcCoordinator::updateVectorscopeHS()
+{
+    return updateScopes(false, false, true, false);
+}
 
-                    histRed[r]++;
-                    histGreen[g]++;
-                    histBlue[b]++;
-                }
-            }
-        }
+bool ImProcCoordinator::updateWaveforms()
+{
+    if (!workimg) {
+        // free memory
+        waveformRed.free();
+        waveformGreen.free();
+        waveformBlue.free();
+        waveformLuma.free();
+        return true;
     }
 
-    hist_lrgb_dirty = false;
-    return true;
-
+    return updateScopes(false, false, false, true);
 }
 
-bool ImProcCoordinator::updateVectorscopeHC()
+bool ImProcCoordinator::updateScopes(bool lrgb, bool hc, bool hs, bool waveform)
 {
-    if (!workimg || !vectorscope_hc_dirty) {
+    lrgb = lrgb && hist_lrgb_dirty;
+    hc = hc && vectorscope_hc_dirty;
+    hs = hs && vectorscope_hs_dirty;
+    waveform = waveform && waveform_dirty;
+
+    if (!workimg || !(lrgb || hc || hs || waveform)) {
         return false;
     }
 
     int x1, y1, x2, y2;
     params->crop.mapToResized(pW, pH, scale, x1, x2, y1, y2);
+    const int width = x2 - x1;
+    // only one row out of 'step' is analyzed
+    const int step = LIM(options.scopeSubsampling, 1, 8);
+    const int rows = (y2 - y1 + step - 1) / step;
 
     constexpr int size = VECTORSCOPE_SIZE;
     constexpr float norm_factor = size / (128.f * 655.36f);
-    vectorscope_hc.fill(0);
+    constexpr float luma_factor = 255.f / 32768.f;
 
-    vectorscopeScale = (x2 - x1) * (y2 - y1);
+    if (lrgb) {
+        histChroma.clear();
+        histLuma.clear();
+        histRed.clear();
+        histGreen.clear();
+        histBlue.clear();
+    }
 
-    const std::unique_ptr<float[]> a(new float[vectorscopeScale]);
-    const std::unique_ptr<float[]> b(new float[vectorscopeScale]);
-    const std::unique_ptr<float[]> L(new float[vectorscopeScale]);
-    ipf.rgb2lab(*workimg, x1, y1, x2 - x1, y2 - y1, L.get(), a.get(), b.get(), params->icm);
-#ifdef _OPENMP
-    #pragma omp parallel
-#endif
-    {
-        array2D<int> vectorscopeThr(size, size, ARRAY2D_CLEAR_DATA);
-#ifdef _OPENMP
-        #pragma omp for nowait
-#endif
-        for (int i = y1; i < y2; ++i) {
-            for (int j = x1, ofs_lab = (i - y1) * (x2 - x1); j < x2; ++j, ++ofs_lab) {
-                const int col = norm_factor * a[ofs_lab] + size / 2 + 0.5f;
-                const int row = norm_factor * b[ofs_lab] + size / 2 + 0.5f;
-                if (col >= 0 && col < size && row >= 0 && row < size) {
-                    vectorscopeThr[row][col]++;
-                }
+    std::unique_ptr<float[]> hcL, hca, hcb;
+
+    if (hc) {
+        vectorscope_hc.fill(0);
+        vectorscopeScale = width * rows;
+        // the H-C vectorscope is computed in the output (or working) space, which is not the one of nprevl
+        hcL.reset(new float[width * rows]);
+        hca.reset(new float[width * rows]);
+        hcb.reset(new float[width * rows]);
+
+        if (step == 1) {
+            ipf.rgb2lab(*workimg, x1, y1, width, rows, hcL.get(), hca.get(), hcb.get(), params->icm);
+        } else {
+            Image8 sampled(width, rows);
+
+            for (int i = 0; i < rows; ++i) {
+                std::copy_n(workimg->data + 3 * ((y1 + i * step) * pW + x1), 3 * width, sampled.data + 3 * i * width);
             }
-        }
-#ifdef _OPENMP
-        #pragma omp critical
-#endif
-        {
-            vectorscope_hc += vectorscopeThr;
+
+            ipf.rgb2lab(sampled, 0, 0, width, rows, hcL.get(), hca.get(), hcb.get(), params->icm);
         }
     }
 
-    vectorscope_hc_dirty = false;
-    return true;
-}
-
-bool ImProcCoordinator::updateVectorscopeHS()
-{
-    if (!workimg || !vectorscope_hs_dirty) {
-        return false;
+    if (hs) {
+        vectorscope_hs.fill(0);
+        vectorscopeScale = width * rows;
     }
 
-    int x1, y1, x2, y2;
-    params->crop.mapToResized(pW, pH, scale, x1, x2, y1, y2);
+    if (waveform) {
+        if (waveformRed.getWidth() != width) {
+            waveformRed(width, 256);
+            waveformGreen(width, 256);
+            waveformBlue(width, 256);
+            waveformLuma(width, 256);
+        }
 
-    constexpr int size = VECTORSCOPE_SIZE;
-    vectorscope_hs.fill(0);
+        waveformRed.fill(0);
+        waveformGreen.fill(0);
+        waveformBlue.fill(0);
+        waveformLuma.fill(0);
+        waveformScale = rows;
+    }
 
-    vectorscopeScale = (x2 - x1) * (y2 - y1);
+    // All the requested scopes are computed in a single pass over vertical strips of the image.
+    // Each thread owns the waveform columns of its strips, while the histograms and vectorscopes
+    // are accumulated per thread and summed up at the end.
+    constexpr int stripWidth = 64;
+    const int strips = (width + stripWidth - 1) / stripWidth;
 
 #ifdef _OPENMP
     #pragma omp parallel
 #endif
     {
-        array2D<int> vectorscopeThr(size, size, ARRAY2D_CLEAR_DATA);
+        LUTu chromaThr, lumaThr, redThr, greenThr, blueThr;
+        array2D<int> hcThr, hsThr;
+
+        if (lrgb) {
+            chromaThr(256, LUT_CLIP_BELOW | LUT_CLIP_ABOVE, true);
+            lumaThr(256, LUT_CLIP_BELOW | LUT_CLIP_ABOVE, true);
+            redThr(256, LUT_CLIP_BELOW | LUT_CLIP_ABOVE, true);
+            greenThr(256, LUT_CLIP_BELOW | LUT_CLIP_ABOVE, true);
+            blueThr(256, LUT_CLIP_BELOW | LUT_CLIP_ABOVE, true);
+        }
+
+        if (hc) {
+            hcThr(size, size, ARRAY2D_CLEAR_DATA);
+        }
+
+        if (hs) {
+            hsThr(size, size, ARRAY2D_CLEAR_DATA);
+        }
+
 #ifdef _OPENMP
-        #pragma omp for nowait
+        #pragma omp for schedule(dynamic) nowait
 #endif
-        for (int i = y1; i < y2; ++i) {
-            int ofs = (i * pW + x1) * 3;
-            for (int j = x1; j < x2; ++j) {
-                const float red = 257.f * workimg->data[ofs++];
-                const float green = 257.f * workimg->data[ofs++];
-                const float blue = 257.f * workimg->data[ofs++];
-                float h, s, l;
-                Color::rgb2hslfloat(red, green, blue, h, s, l);
-                const auto sincosval = xsincosf(2.f * RT_PI_F * h);
-                const int col = s * sincosval.y * (size / 2) + size / 2;
-                const int row = s * sincosval.x * (size / 2) + size / 2;
-                if (col >= 0 && col < size && row >= 0 && row < size) {
-                    vectorscopeThr[row][col]++;
+        for (int strip = 0; strip < strips; ++strip) {
+            const int x = strip * stripWidth;
+            const int w = std::min(stripWidth, width - x);
+
+            for (int row = 0; row < rows; ++row) {
+                const int i = y1 + row * step;
+                const unsigned char* rgb = workimg->data + 3 * (i * pW + x1 + x);
+                const float* L = nprevl->L[i] + x1 + x;
+                const float* a = nprevl->a[i] + x1 + x;
+                const float* b = nprevl->b[i] + x1 + x;
+
+                for (int j = 0; j < w; ++j) {
+                    const int red = rgb[3 * j];
+                    const int green = rgb[3 * j + 1];
+                    const int blue = rgb[3 * j + 2];
+
+                    if (lrgb) {
+                        chromaThr[(int)(sqrtf(SQR(a[j]) + SQR(b[j])) / 188.f)]++; //188 = 48000/256
+                        lumaThr[(int)(L[j] / 128.f)]++;
+                        redThr[red]++;
+                        greenThr[green]++;
+                        blueThr[blue]++;
+                    }
+
+                    if (hc) {
+                        const int ofs_lab = row * width + x + j;
+                        const int col = norm_factor * hca[ofs_lab] + size / 2 + 0.5f;
+                        const int vrow = norm_factor * hcb[ofs_lab] + size / 2 + 0.5f;
+                        if (col >= 0 && col < size && vrow >= 0 && vrow < size) {
+                            hcThr[vrow][col]++;
+                        }
+                    }
+
+                    if (hs) {
+                        float h, s, l;
+                        Color::rgb2hslfloat(257.f * red, 257.f * green, 257.f * blue, h, s, l);
+                        const auto sincosval = xsincosf(2.f * RT_PI_F * h);
+                        const int col = s * sincosval.y * (size / 2) + size / 2;
+                        const int vrow = s * sincosval.x * (size / 2) + size / 2;
+                        if (col >= 0 && col < size && vrow >= 0 && vrow < size) {
+                            hsThr[vrow][col]++;
+                        }
+                    }
+
+                    if (waveform) {
+                        waveformRed[red][x + j]++;
+                        waveformGreen[green][x + j]++;
+                        waveformBlue[blue][x + j]++;
+                        waveformLuma[LIM<int>(L[j] * luma_factor, 0, 255)][x + j]++;
+                    }
                 }
             }
         }
+
 #ifdef _OPENMP
         #pragma omp critical
 #endif
         {
-            vectorscope_hs += vectorscopeThr;
-        }
-    }
+            if (lrgb) {
+                histChroma += chromaThr;
+                histLuma += lumaThr;
+                histRed += redThr;
+                histGreen += greenThr;
+                histBlue += blueThr;
+            }
 
-    vectorscope_hs_dirty = false;
-    return true;
-}
+            if (hc) {
+                vectorscope_hc += hcThr;
+            }
 
-bool ImProcCoordinator::updateWaveforms()
-{
-    if (!workimg) {
-        // free memory
-        waveformRed.free();
-        waveformGreen.free();
-        waveformBlue.free();
-        waveformLuma.free();
-        return true;
+            if (hs) {
+                vectorscope_hs += hsThr;
+            }
+        }
     }
 
-    if (!waveform_dirty) {
-        return false;
+    if (lrgb) {
+        hist_lrgb_dirty = false;
     }
 
-    int x1, y1, x2, y2;
-    params->crop.mapToResized(pW, pH, scale, x1, x2, y1, y2);
-    int waveform_width = waveformRed.getWidth();
-
-    if (waveform_width != x2 - x1) {
-        // Resize waveform arrays.
-        waveform_width = x2 - x1;
-        waveformRed(waveform_width, 256);
-        waveformGreen(waveform_width, 256);
-        waveformBlue(waveform_width, 256);
-        waveformLuma(waveform_width, 256);
+    if (hc) {
+        vectorscope_hc_dirty = false;
     }
 
-    // Start with zero.
-    waveformRed.fill(0);
-    waveformGreen.fill(0);
-    waveformBlue.fill(0);
-    waveformLuma.fill(0);
+    if (hs) {
+        vectorscope_hs_dirty = false;
+    }
 
-    constexpr float luma_factor = 255.f / 32768.f;
-    for (int i = y1; i < y2; i++) {
-        int ofs = (i * pW + x1) * 3;
-        float* L_row = nprevl->L[i] + x1;
-
-        for (int j = 0; j < waveform_width; j++) {
-            waveformRed[workimg->data[ofs++]][j]++;
-            waveformGreen[workimg->data[ofs++]][j]++;
-            waveformBlue[workimg->data[ofs++]][j]++;
-            waveformLuma[LIM<int>(L_row[j] * luma_factor, 0, 255)][j]++;
-        }
+    if (waveform) {
+        waveform_dirty = false;
     }
 
-    waveformScale = y2 - y1;
-    waveform_dirty = false;
     return true;
 }
 
@@ -2782,6 +2858,11 @@ void ImProcCoordinator::startProcessing(int changeCode)
 {
     paramsUpdateMutex.lock();
     changeSinceLast |= changeCode;
+
+    if (cancellable && (changeCode & (M_VOID - 1))) {
+        updateCancelled = true;
+    }
+
     paramsUpdateMutex.unlock();
 
     startProcessing();
@@ -2795,9 +2876,14 @@ void ImProcCoordinator::process()
 
     paramsUpdateMutex.lock();
 
+    // Change whose refinement has been skipped or cancelled in favour of a newer change, it has to be handled again
+    int pendingChange = 0;
+    bool pendingPanningRelatedChange = false;
+
     while (changeSinceLast) {
         const bool panningRelatedChange =
-            params->toneCurve.isPanningRelatedChange(nextParams->toneCurve)
+            pendingPanningRelatedChange
+            || params->toneCurve.isPanningRelatedChange(nextParams->toneCurve)
             || params->labCurve != nextParams->labCurve
             || params->locallab != nextParams->locallab
             || params->localContrast != nextParams->localContrast
@@ -2839,8 +2925,10 @@ void ImProcCoordinator::process()
 
         sharpMaskChanged = false;
         *params = *nextParams;
-        int change = changeSinceLast;
+        int change = changeSinceLast | pendingChange;
         changeSinceLast = 0;
+        pendingChange = 0;
+        pendingPanningRelatedChange = false;
 
         if (tweakOperator) {
             // TWEAKING THE PROCPARAMS FOR THE SPOT ADJUSTMENT MODE
@@ -2854,7 +2942,32 @@ void ImProcCoordinator::process()
 
         // M_VOID means no update, and is a bit higher that the rest
         if (change & (M_VOID - 1)) {
-            updatePreviewImage(change, panningRelatedChange);
+            if (needsProgressivePreview(change, panningRelatedChange)) {
+                // show a coarse rendering first, it is never cancelled so that continuous changes keep showing feedback
+                updatePreviewImage(change, panningRelatedChange, true);
+            }
+
+            // the regular pass is skipped if a newer change is already waiting, and cancelled if one arrives
+            // meanwhile, the change is then merged into the newer one
+            paramsUpdateMutex.lock();
+            cancellable = !changeSinceLast;
+            updateCancelled = false;
+            paramsUpdateMutex.unlock();
+
+            if (cancellable) {
+                updatePreviewImage(change, panningRelatedChange);
+            }
+
+            paramsUpdateMutex.lock();
+
+            if (!cancellable || updateCancelled) {
+                pendingChange = change;
+                pendingPanningRelatedChange = panningRelatedChange;
+            }
+
+            cancellable = false;
+            updateCancelled = false;
+            paramsUpdateMutex.unlock();
         }
 
         paramsUpdateMutex.lock();
@@ -2885,6 +2998,11 @@ void ImProcCoordinator::endUpdateParams(int changeFlags)
 {
     changeSinceLast |= changeFlags;
 
+    if (cancellable && (changeFlags & (M_VOID - 1))) {
+        // the refinement in progress is superseded, see process()
+        updateCancelled = true;
+    }
+
     paramsUpdateMutex.unlock();
     startProcessing();
 }
@@ -18,6 +18,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "array2D.h"
@@ -91,6 +92,7 @@ protected:
     bool sharpMask;
     bool sharpMaskChanged;
     int scale;
+    bool coarsePreview; // the preview buffers hold a quick rendering at coarsePreviewFactor times the regular scale
     bool highDetailPreprocessComputed;
     bool highDetailRawComputed;
     bool allocated;
@@ -222,8 +224,13 @@ protected:
     bool updateVectorscopeHS();
     /// Updates all waveforms. Returns true unless not updated.
     bool updateWaveforms();
-    void setScale(int prevscale);
-    void updatePreviewImage (int todo, bool panningRelatedChange);
+    /// Updates the requested histograms, vectorscopes and waveforms in a single pass. Returns true unless none was updated.
+    bool updateScopes(bool lrgb, bool hc, bool hs, bool waveform);
+    void setScale(int prevscale, bool coarse = false);
+    bool needsProgressivePreview(int todo, bool panningRelatedChange) const;
+    void updatePreviewImage (int todo, bool panningRelatedChange, bool coarse = false);
+
+    static constexpr int coarsePreviewFactor = 4;
 
     MyMutex mProcessing;
     const std::unique_ptr<ProcParams> params;  // used for the rendering, can be eventually tweaked
@@ -243,6 +250,8 @@ protected:
     MyMutex paramsUpdateMutex;
     int  changeSinceLast;
     bool updaterRunning;
+    bool cancellable; // a new change cancels the update in progress, guarded by paramsUpdateMutex
+    std::atomic<bool> updateCancelled; // checked by ipf
     const std::unique_ptr<ProcParams> nextParams;
     bool destroying;
     bool utili;
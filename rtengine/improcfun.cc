@@ -48,6 +48,7 @@
 #include "satandvalueblendingcurve.h"
 #include "StopWatch.h"
 #include "utils.h"
+#include "warpmap.h"
 
 #include "../rtgui/editcallbacks.h"
 
@@ -284,6 +285,17 @@ namespace rtengine
 
 using namespace procparams;
 
+ImProcFunctions::ImProcFunctions(const ProcParams* iparams, bool imultiThread) :
+    monitorTransform(nullptr),
+    warpMaps(new WarpMapCache),
+    params(iparams),
+    scale(1),
+    multiThread(imultiThread),
+    cancelled(nullptr),
+    lumimul{}
+{
+}
+
 ImProcFunctions::~ImProcFunctions()
 {
     if (monitorTransform) {
@@ -305,10 +317,12 @@ void ImProcFunctions::updateColorProfiles(const Glib::ustring& monitorProfile, R
     }
 
     gamutWarning.reset(nullptr);
+    monitorShaper.reset();
 
     monitorTransform = nullptr;
 
     cmsHPROFILE monitor = nullptr;
+    bool softProofCreated = false;
 
     if (!monitorProfile.empty()) {
 #if !defined(__APPLE__) // No support for monitor profiles on OS X, all data is sRGB
@@ -327,8 +341,6 @@ void ImProcFunctions::updateColorProfiles(const Glib::ustring& monitorProfile, R
         cmsUInt32Number gamutbpc = 0;
         RenderingIntent gamutintent = RI_RELATIVE;
 
-        bool softProofCreated = false;
-
         if (softProof) {
             cmsHPROFILE oprof = nullptr;
             RenderingIntent outIntent;
@@ -446,6 +458,10 @@ void ImProcFunctions::updateColorProfiles(const Glib::ustring& monitorProfile, R
 
         cmsCloseProfile(iprof);
     }
+
+    if (monitorTransform && !softProofCreated && !gamutWarning) {
+        monitorShaper = ICCStore::getInstance()->getMatrixShaper(monitor, monitorIntent);
+    }
 }
 
 void ImProcFunctions::firstAnalysis(const Imagefloat* const original, const ProcParams &params, LUTu & histogram)
@@ -2168,6 +2184,10 @@ void ImProcFunctions::rgbProc(Imagefloat* working, LabImage* lab, PipetteBuffer
     }
 
     bool hasColorToning = params->colorToning.enabled && bool (ctOpacityCurve) &&  bool (ctColorCurve) && params->colorToning.method != "LabGrid";
+
+    if (hasColorToning) {
+        Color::initExtraGammas(); // used by labtoning
+    }
 //    bool hasColorToningLabGrid = params->colorToning.enabled && params->colorToning.method == "LabGrid";
     //  float satLimit = float(params->colorToning.satProtectionThreshold)/100.f*0.7f+0.3f;
     //  float satLimitOpacity = 1.f-(float(params->colorToning.saturatedOpacity)/100.f);
@@ -4287,6 +4307,10 @@ void ImProcFunctions::chromiLuminanceCurve(PipetteBuffer *pipetteBuffer, int pW,
         gamutmuns = 4;
     }
 
+    if (gamutmuns > 0) {
+        Color::initMunsell();
+    }
+
     const float protectRed = (float)settings->protectred;
     const double protectRedH = settings->protectredh;
     const float protect_red = rtengine::LIM<float>(protectRed, 20.f, 180.f); //default=60  chroma: one can put more or less if necessary...in 'option'  40...160
@@ -5772,11 +5796,8 @@ void ImProcFunctions::rgb2lab(const Image8 &src, int x, int y, int w, int h, flo
             flags |= cmsFLAGS_BLACKPOINTCOMPENSATION;
         }
 
-        lcmsMutex->lock();
-        cmsHPROFILE LabIProf  = cmsCreateLab4Profile(nullptr);
-        cmsHTRANSFORM hTransform = cmsCreateTransform(oprof, TYPE_RGB_8, LabIProf, TYPE_Lab_FLT, icm.outputIntent, flags);
-        cmsCloseProfile(LabIProf);
-        lcmsMutex->unlock();
+        const std::shared_ptr<void> transform = ICCStore::getInstance()->getTransform(oprof, TYPE_RGB_8, ICCStore::getInstance()->getLabProfile(), TYPE_Lab_FLT, icm.outputIntent, flags);
+        const cmsHTRANSFORM hTransform = transform.get();
 
         // cmsDoTransform is relatively expensive
 #ifdef _OPENMP
@@ -5807,8 +5828,6 @@ void ImProcFunctions::rgb2lab(const Image8 &src, int x, int y, int w, int h, flo
                 }
             }
         } // End of parallelization
-
-        cmsDeleteTransform(hTransform);
     } else {
         TMatrix wprof = ICCStore::getInstance()->workingSpaceMatrix(profile);
         const float wp[3][3] = {
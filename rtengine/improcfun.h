@@ -18,6 +18,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -73,6 +74,7 @@ class WavOpacityCurveSH;
 class WavOpacityCurveRG;
 class WavOpacityCurveW;
 class WavOpacityCurveWL;
+class WarpMapCache;
 
 class CieImage;
 class Image8;
@@ -81,6 +83,7 @@ class LabImage;
 class wavelet_decomposition;
 class ImageSource;
 class ColorTemp;
+struct MatrixShaper;
 
 namespace procparams
 {
@@ -109,19 +112,21 @@ enum RenderingIntent : int;
 class ImProcFunctions
 {
     cmsHTRANSFORM monitorTransform;
+    std::shared_ptr<const MatrixShaper> monitorShaper; // replaces monitorTransform when the monitor profile is a plain matrix-shaper
     std::unique_ptr<GamutWarning> gamutWarning;
+    std::unique_ptr<WarpMapCache> warpMaps;
     Cairo::RefPtr<Cairo::ImageSurface> locImage;
 
     const procparams::ProcParams* params;
     double scale;
     bool multiThread;
+    const std::atomic<bool>* cancelled; // owned by the caller, see setCancellation()
 
     void calcVignettingParams(int oW, int oH, const procparams::VignettingParams& vignetting, double &w2, double &h2, double& maxRadius, double &v, double &b, double &mul);
     static void rgb2lab(const Image8 &src, int x, int y, int w, int h, float L[], float a[], float b[], const procparams::ColorManagementParams &icm, bool consider_histogram_settings, bool multithread);
 
     void transformLuminanceOnly(Imagefloat* original, Imagefloat* transformed, int cx, int cy, int oW, int oH, int fW, int fH);
-    void transformGeneral(bool highQuality, Imagefloat *original, Imagefloat *transformed, int cx, int cy, int sx, int sy, int oW, int oH, int fW, int fH, const LensCorrection *pLCPMap, bool useOriginalBuffer);
-    void transformLCPCAOnly(Imagefloat *original, Imagefloat *transformed, int cx, int cy, const LensCorrection *pLCPMap, bool useOriginalBuffer);
+    void transformGeneral(bool highQuality, Imagefloat *original, Imagefloat *transformed, int cx, int cy, int sx, int sy, int oW, int oH, int fW, int fH, const LensCorrection *pLCPMap, const FramesMetaData *metadata, int rawRotationDeg, bool useOriginalBuffer);
 
     bool needsCA() const;
     bool needsDistortion() const;
@@ -150,9 +155,20 @@ enum class BlurType {
 
     double lumimul[3];
 
-    explicit ImProcFunctions(const procparams::ProcParams* iparams, bool imultiThread = true)
-        : monitorTransform(nullptr), params(iparams), scale(1), multiThread(imultiThread), lumimul{} {}
+    explicit ImProcFunctions(const procparams::ProcParams* iparams, bool imultiThread = true);
     ~ImProcFunctions();
+    /**
+     * Lets the heavy stages (wavelet and denoise tiles, Fattal tone mapping) stop early once *flag becomes true.
+     * The output of a cancelled stage is incomplete, it's up to the caller to check isCancelled() and discard it.
+     */
+    void setCancellation(const std::atomic<bool>* flag)
+    {
+        cancelled = flag;
+    }
+    bool isCancelled() const
+    {
+        return cancelled && cancelled->load(std::memory_order_relaxed);
+    }
     bool needsLuminanceOnly() const
     {
         return !(needsCA() || needsDistortion() || needsRotation() || needsPerspective() || needsLCP() || needsLensfun()) && (needsVignetting() || needsPCVignetting() || needsGradient());
@@ -210,7 +226,7 @@ enum class BlurType {
     void sharpeningcam(CieImage* ncie, float** buffer, bool showMask = false);
     void transform(Imagefloat* original, Imagefloat* transformed, int cx, int cy, int sx, int sy, int oW, int oH, int fW, int fH, const FramesMetaData *metadata, int rawRotationDeg, bool fullImage, bool useOriginalBuffer = false);
     float resizeScale(const procparams::ProcParams* params, int fw, int fh, int &imw, int &imh);
-    void lab2monitorRgb(LabImage* lab, Image8* image);
+    void lab2monitorRgb(LabImage* lab, Image8* image, int cx = 0, int cy = 0);
     void resize(Imagefloat* src, Imagefloat* dst, float dScale);
     void Lanczos(const LabImage* src, LabImage* dst, float scale);
     void Lanczos(const Imagefloat* src, Imagefloat* dst, float scale);
@@ -44,20 +44,10 @@ const Settings* settings;
 MyMutex* lcmsMutex = nullptr;
 MyMutex *fftwMutex = nullptr;
 
-int init (const Settings* s, const Glib::ustring& baseDir, const Glib::ustring& userSettingsDir, bool loadAll)
+namespace
 {
-    settings = s;
-    ProcParams::init();
-    PerceptualToneCurve::init();
-    RawImageSource::init();
 
-#ifdef _OPENMP
-#pragma omp parallel sections if (!settings->verbose)
-#endif
-{
-#ifdef _OPENMP
-#pragma omp section
-#endif
+void initLensfun(const Settings* s, const Glib::ustring& baseDir)
 {
     bool ok;
 
@@ -75,6 +65,32 @@ int init (const Settings* s, const Glib::ustring& baseDir, const Glib::ustring&
         }
     }
 }
+
+}
+
+int init (const Settings* s, const Glib::ustring& baseDir, const Glib::ustring& userSettingsDir, bool loadAll)
+{
+    settings = s;
+    ProcParams::init();
+    PerceptualToneCurve::init();
+    RawImageSource::init();
+
+#ifdef _OPENMP
+#pragma omp parallel sections if (!settings->verbose)
+#endif
+{
+#ifdef _OPENMP
+#pragma omp section
+#endif
+{
+    if (loadAll) {
+        initLensfun(s, baseDir);
+    } else {
+        LFDatabase::initDeferred([s, baseDir]() {
+            initLensfun(s, baseDir);
+        });
+    }
+}
 #ifdef _OPENMP
 #pragma omp section
 #endif
@@ -97,19 +113,31 @@ int init (const Settings* s, const Glib::ustring& baseDir, const Glib::ustring&
 #pragma omp section
 #endif
 {
-    CameraConstantsStore::getInstance()->init(baseDir, userSettingsDir);
+    if (loadAll) {
+        CameraConstantsStore::getInstance()->init(baseDir, userSettingsDir);
+    } else {
+        CameraConstantsStore::getInstance()->initDeferred(baseDir, userSettingsDir);
+    }
 }
 #ifdef _OPENMP
 #pragma omp section
 #endif
 {
-    DFManager::getInstance().init(s->darkFramesPath);
+    if (loadAll) {
+        DFManager::getInstance().init(s->darkFramesPath);
+    } else {
+        DFManager::getInstance().initDeferred(s->darkFramesPath);
+    }
 }
 #ifdef _OPENMP
 #pragma omp section
 #endif
 {
-    ffm.init(s->flatFieldsPath);
+    if (loadAll) {
+        ffm.init(s->flatFieldsPath);
+    } else {
+        ffm.initDeferred(s->flatFieldsPath);
+    }
 }
 }
 
@@ -122,6 +150,7 @@ int init (const Settings* s, const Glib::ustring& baseDir, const Glib::ustring&
 
 void cleanup ()
 {
+    ProfileStore::getInstance()->stopIndexCheck ();
     ProcParams::cleanup ();
     Color::cleanup ();
     RawImageSource::cleanup ();
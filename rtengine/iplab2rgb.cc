@@ -44,10 +44,11 @@ inline void copyAndClampLine(const float *src, unsigned char *dst, const int W)
 }
 
 
-inline void copyAndClamp(const LabImage *src, unsigned char *dst, const double rgb_xyz[3][3], bool multiThread)
+// Converts the cw x ch region of src starting at (cx, cy)
+inline void copyAndClamp(const LabImage *src, int cx, int cy, int cw, int ch, unsigned char *dst, const double rgb_xyz[3][3], bool multiThread)
 {
-    const int W = src->W;
-    const int H = src->H;
+    const int W = cw;
+    const int H = ch;
 
     float rgb_xyzf[3][3];
 
@@ -70,9 +71,9 @@ inline void copyAndClamp(const LabImage *src, unsigned char *dst, const double r
         #pragma omp parallel for schedule(dynamic,16) if (multiThread)
 #endif
     for (int i = 0; i < H; ++i) {
-        float* rL = src->L[i];
-        float* ra = src->a[i];
-        float* rb = src->b[i];
+        const float* rL = src->L[cy + i] + cx;
+        const float* ra = src->a[cy + i] + cx;
+        const float* rb = src->b[cy + i] + cx;
         int ix = i * 3 * W;
 
 #ifdef __SSE2__
@@ -120,6 +121,81 @@ inline void copyAndClamp(const LabImage *src, unsigned char *dst, const double r
     }
 }
 
+// Same as copyAndClamp, with the matrix and tone curves of a matrix-shaper profile
+// Like the LCMS path it replaces, the output is rounded, not dithered
+void matrixShaperCopyAndClamp(const LabImage *src, int cx, int cy, int cw, int ch, unsigned char *dst, const MatrixShaper &shaper, bool multiThread)
+{
+    float xyz_rgbf[3][3];
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            xyz_rgbf[i][j] = shaper.xyzToRgb[i][j];
+        }
+    }
+
+#ifdef __SSE2__
+    vfloat xyz_rgbv[3][3];
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            xyz_rgbv[i][j] = F2V(xyz_rgbf[i][j]);
+        }
+    }
+#endif
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic,16) if (multiThread)
+#endif
+    for (int i = 0; i < ch; ++i) {
+        const float* rL = src->L[cy + i] + cx;
+        const float* ra = src->a[cy + i] + cx;
+        const float* rb = src->b[cy + i] + cx;
+        int ix = i * 3 * cw;
+
+#ifdef __SSE2__
+        float rbuffer[cw] ALIGNED16;
+        float gbuffer[cw] ALIGNED16;
+        float bbuffer[cw] ALIGNED16;
+        int j = 0;
+        for (; j < cw - 3; j += 4) {
+            vfloat R, G, B;
+            vfloat x_, y_, z_;
+            Color::Lab2XYZ(LVFU(rL[j]), LVFU(ra[j]), LVFU(rb[j]), x_, y_, z_ );
+            Color::xyz2rgb(x_, y_, z_, R, G, B, xyz_rgbv);
+            STVF(rbuffer[j], shaper.trc[0][R]);
+            STVF(gbuffer[j], shaper.trc[1][G]);
+            STVF(bbuffer[j], shaper.trc[2][B]);
+        }
+        for (; j < cw; ++j) {
+            float R, G, B;
+            float x_, y_, z_;
+            Color::Lab2XYZ(rL[j], ra[j], rb[j], x_, y_, z_ );
+            Color::xyz2rgb(x_, y_, z_, R, G, B, xyz_rgbf);
+            rbuffer[j] = shaper.trc[0][R];
+            gbuffer[j] = shaper.trc[1][G];
+            bbuffer[j] = shaper.trc[2][B];
+        }
+
+        for (j = 0; j < cw; ++j) {
+            dst[ix++] = uint16ToUint8Rounded(rbuffer[j]);
+            dst[ix++] = uint16ToUint8Rounded(gbuffer[j]);
+            dst[ix++] = uint16ToUint8Rounded(bbuffer[j]);
+        }
+
+#else
+        for (int j = 0; j < cw; ++j) {
+            float R, G, B;
+            float x_, y_, z_;
+            Color::Lab2XYZ(rL[j], ra[j], rb[j], x_, y_, z_ );
+            Color::xyz2rgb(x_, y_, z_, R, G, B, xyz_rgbf);
+
+            dst[ix++] = uint16ToUint8Rounded(shaper.trc[0][R]);
+            dst[ix++] = uint16ToUint8Rounded(shaper.trc[1][G]);
+            dst[ix++] = uint16ToUint8Rounded(shaper.trc[2][B]);
+        }
+#endif
+    }
+}
+
 } // namespace
 
 
@@ -139,14 +215,20 @@ vfloat gammalog(vfloat x, vfloat p, vfloat s, vfloat g3, vfloat g4)
 //         Crop::update                           (rtengine/dcrop.cc)
 //         Thumbnail::processImage                (rtengine/rtthumbnail.cc)
 //
-// If monitorTransform, divide by 327.68 then apply monitorTransform (which can integrate soft-proofing)
+// Converts the region of lab starting at (cx, cy) which has the size of image
+//
+// If monitorShaper, convert to xyz and apply the matrix and tone curves of the monitor profile
+// else if monitorTransform, divide by 327.68 then apply monitorTransform (which can integrate soft-proofing)
 // otherwise divide by 327.68, convert to xyz and apply the sRGB transform, before converting with gamma2curve
-void ImProcFunctions::lab2monitorRgb(LabImage* lab, Image8* image)
+void ImProcFunctions::lab2monitorRgb(LabImage* lab, Image8* image, int cx, int cy)
 {
-    if (monitorTransform) {
+    const int W = image->getWidth();
+    const int H = image->getHeight();
+
+    if (monitorShaper) {
+        matrixShaperCopyAndClamp(lab, cx, cy, W, H, image->data, *monitorShaper, multiThread);
+    } else if (monitorTransform) {
 
-        const int W = lab->W;
-        const int H = lab->H;
         unsigned char * data = image->data;
 
         // cmsDoTransform is relatively expensive
@@ -154,16 +236,16 @@ void ImProcFunctions::lab2monitorRgb(LabImage* lab, Image8* image)
         #pragma omp parallel firstprivate(lab, data, W, H)
 #endif
         {
-            AlignedBuffer<float> pBuf(3 * lab->W);
+            AlignedBuffer<float> pBuf(3 * W);
 
             AlignedBuffer<float> mBuf;
             AlignedBuffer<float> gwBuf1;
             AlignedBuffer<float> gwBuf2;
 
             if (gamutWarning) {
-                gwBuf1.resize(3 * lab->W);
-                gwBuf2.resize(3 * lab->W);
-                mBuf.resize(3 * lab->W);
+                gwBuf1.resize(3 * W);
+                gwBuf2.resize(3 * W);
+                mBuf.resize(3 * W);
             }
 
             float *buffer = pBuf.data;
@@ -178,9 +260,9 @@ void ImProcFunctions::lab2monitorRgb(LabImage* lab, Image8* image)
                 const int ix = i * 3 * W;
                 int iy = 0;
 
-                float* rL = lab->L[i];
-                float* ra = lab->a[i];
-                float* rb = lab->b[i];
+                const float* rL = lab->L[cy + i] + cx;
+                const float* ra = lab->a[cy + i] + cx;
+                const float* rb = lab->b[cy + i] + cx;
 
                 for (int j = 0; j < W; j++) {
                     buffer[iy++] = rL[j] / 327.68f;
@@ -197,7 +279,7 @@ void ImProcFunctions::lab2monitorRgb(LabImage* lab, Image8* image)
             }
         } // End of parallelization
     } else {
-        copyAndClamp(lab, image->data, sRGB_xyz, multiThread);
+        copyAndClamp(lab, cx, cy, W, H, image->data, sRGB_xyz, multiThread);
     }
 }
 
@@ -208,7 +290,8 @@ void ImProcFunctions::lab2monitorRgb(LabImage* lab, Image8* image)
 //
 // Generate an Image8
 //
-// If output profile used, divide by 327.68 then apply the "profile" profile (eventually with a standard gamma)
+// If output profile used, divide by 327.68 then apply the "profile" profile (eventually with a standard gamma),
+// or its matrix and tone curves directly if it is a plain matrix-shaper profile
 // otherwise divide by 327.68, convert to xyz and apply the RGB transform, before converting with gamma2curve
 Image8* ImProcFunctions::lab2rgb(LabImage* lab, int cx, int cy, int cw, int ch, const procparams::ColorManagementParams &icm, bool consider_histogram_settings)
 {
@@ -245,14 +328,15 @@ Image8* ImProcFunctions::lab2rgb(LabImage* lab, int cx, int cy, int cw, int ch,
         oprof = ICCStore::getInstance()->getProfile(profile);
     }
 
-    if (oprof) {
+    const std::shared_ptr<const MatrixShaper> shaper = oprof ? ICCStore::getInstance()->getMatrixShaper(oprof, icm.outputIntent) : nullptr;
+
+    if (shaper) {
+        matrixShaperCopyAndClamp(lab, cx, cy, cw, ch, image->data, *shaper, multiThread);
+    } else if (oprof) {
         const cmsUInt32Number flags = cmsFLAGS_NOOPTIMIZE | cmsFLAGS_NOCACHE | (icm.outputBPC ? cmsFLAGS_BLACKPOINTCOMPENSATION : 0); // NOCACHE is important for thread safety
 
-        lcmsMutex->lock();
-        cmsHPROFILE LabIProf  = cmsCreateLab4Profile(nullptr);
-        cmsHTRANSFORM hTransform = cmsCreateTransform (LabIProf, TYPE_Lab_DBL, oprof, TYPE_RGB_FLT, icm.outputIntent, flags);
-        cmsCloseProfile(LabIProf);
-        lcmsMutex->unlock();
+        const std::shared_ptr<void> transform = ICCStore::getInstance()->getTransform(ICCStore::getInstance()->getLabProfile(), TYPE_Lab_DBL, oprof, TYPE_RGB_FLT, icm.outputIntent, flags);
+        const cmsHTRANSFORM hTransform = transform.get();
 
         unsigned char *data = image->data;
 
@@ -272,7 +356,7 @@ Image8* ImProcFunctions::lab2rgb(LabImage* lab, int cx, int cy, int cw, int ch,
 #endif
 
             for (int i = cy; i < condition; i++) {
-                const int ix = i * 3 * cw;
+                const int ix = (i - cy) * 3 * cw;
                 int iy = 0;
                 float* rL = lab->L[i];
                 float* ra = lab->a[i];
@@ -288,12 +372,9 @@ Image8* ImProcFunctions::lab2rgb(LabImage* lab, int cx, int cy, int cw, int ch,
                 copyAndClampLine(outbuffer, data + ix, cw);
             }
         } // End of parallelization
-
-        cmsDeleteTransform(hTransform);
-
     } else {
         const auto xyz_rgb = ICCStore::getInstance()->workingSpaceInverseMatrix(profile);
-        copyAndClamp(lab, image->data, xyz_rgb, multiThread);
+        copyAndClamp(lab, cx, cy, cw, ch, image->data, xyz_rgb, multiThread);
     }
 
     return image;
@@ -344,13 +425,9 @@ Imagefloat* ImProcFunctions::lab2rgbOut(LabImage* lab, int cx, int cy, int cw, i
             flags |= cmsFLAGS_BLACKPOINTCOMPENSATION;
         }
 
-        lcmsMutex->lock();
-        cmsHPROFILE iprof = cmsCreateLab4Profile(nullptr);
-        cmsHTRANSFORM hTransform = cmsCreateTransform(iprof, TYPE_Lab_FLT, oprof, TYPE_RGB_FLT, icm.outputIntent, flags);
-        lcmsMutex->unlock();
+        const std::shared_ptr<void> transform = ICCStore::getInstance()->getTransform(ICCStore::getInstance()->getLabProfile(), TYPE_Lab_FLT, oprof, TYPE_RGB_FLT, icm.outputIntent, flags);
 
-        image->ExecCMSTransform(hTransform, *lab, cx, cy);
-        cmsDeleteTransform(hTransform);
+        image->ExecCMSTransform(transform.get(), *lab, cx, cy);
         image->normalizeFloatTo65535();
     } else {
         
@@ -12239,6 +12239,8 @@ void ImProcFunctions::avoidcolshi(const struct local_params& lp, int sp, LabImag
         return;
     }
 
+    Color::initMunsell();
+
     if (avoidgamut > 0  && lp.islocal) {
         const float ach = lp.trans / 100.f;
         bool execmunsell = true;
@@ -173,19 +173,15 @@ void toneEqualizer(
 
     std::vector<std::array<float, 3>> cur_colormap;
     if (params.show_colormap) {
-        rtengine::lcmsMutex->lock();
         cmsHPROFILE in = rtengine::ICCStore::getInstance()->getsRGBProfile();
         cmsHPROFILE out = rtengine::ICCStore::getInstance()->workingSpace(workingProfile);
-        cmsHTRANSFORM xform = cmsCreateTransform(in, TYPE_RGB_FLT, out, TYPE_RGB_FLT, INTENT_RELATIVE_COLORIMETRIC, cmsFLAGS_NOOPTIMIZE | cmsFLAGS_NOCACHE);
-        rtengine::lcmsMutex->unlock();
+        const std::shared_ptr<void> xform = rtengine::ICCStore::getInstance()->getTransform(in, TYPE_RGB_FLT, out, TYPE_RGB_FLT, INTENT_RELATIVE_COLORIMETRIC, cmsFLAGS_NOOPTIMIZE | cmsFLAGS_NOCACHE);
 
         for (auto &c : colormap) {
             cur_colormap.push_back(c);
             auto &cc = cur_colormap.back();
-            cmsDoTransform(xform, &cc[0], &cc[0], 1);
+            cmsDoTransform(xform.get(), &cc[0], &cc[0], 1);
         }
-
-        cmsDeleteTransform(xform);
     }
 
     const auto process_colormap =
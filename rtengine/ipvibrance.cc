@@ -155,6 +155,10 @@ void ImProcFunctions::vibrance (LabImage* lab, const procparams::VibranceParams
     const bool protectskins = vibranceParams.protectskins;
     const bool avoidcolorshift = vibranceParams.avoidcolorshift;
 
+    if (avoidcolorshift) {
+        Color::initMunsell();
+    }
+
     TMatrix wiprof = ICCStore::getInstance()->workingSpaceInverseMatrix (workingProfile);
     //inverse matrix user select
     const float wip[3][3] = {
@@ -254,6 +254,10 @@ void ImProcFunctions::ip_wavelet(LabImage * lab, LabImage * dst, int kall, const
 
     cp.avoi = params->wavelet.avoid;
 
+    if (cp.avoi) {
+        Color::initMunsell();
+    }
+
     if (params->wavelet.complexmethod == "normal") {
         cp.complex = 0;
     } else if (params->wavelet.complexmethod == "expert") {
@@ -877,6 +881,10 @@ void ImProcFunctions::ip_wavelet(LabImage * lab, LabImage * dst, int kall, const
 
         for (int tiletop = 0; tiletop < imheight; tiletop += tileHskip) {
             for (int tileleft = 0; tileleft < imwidth ; tileleft += tileWskip) {
+                if (isCancelled()) {
+                    continue;
+                }
+
                 int tileright = rtengine::min(imwidth, tileleft + tilewidth);
                 int tilebottom = rtengine::min(imheight, tiletop + tileheight);
                 int width  = tileright - tileleft;
@@ -2094,6 +2102,10 @@ void ImProcFunctions::ip_wavelet(LabImage * lab, LabImage * dst, int kall, const
         delete dsttmp;
     }
 
+    if (isCancelled()) {
+        return;
+    }
+
     if (waparams.softradend > 0.f  && cp.finena) {
         float guid = waparams.softradend;
         float strend = waparams.strend;
@@ -94,6 +94,7 @@ void RawImageSource::lmmse_interpolate_omp(int winw, int winh, const array2D<flo
         iter = 0;
     } else {
         applyGamma = true;
+        Color::initLmmseGammas();
     }
 
     float *rix[5];
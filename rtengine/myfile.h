@@ -137,6 +137,28 @@ inline unsigned char* fdata(int offset, IMFILE* f)
     return (unsigned char*)f->data + offset;
 }
 
+// Like fread, but returns the data in place instead of copying it, or nullptr if the file is too short.
+// The data stays valid until the file is closed and must not be written (it's mapped read only).
+inline const char* fmap (size_t size, IMFILE* f)
+{
+    if (static_cast<size_t>(f->size - f->pos) < size) {
+        return nullptr;
+    }
+
+    const char* const data = f->data + f->pos;
+    f->pos += size;
+
+    if (f->plistener) {
+        f->progress_current += size;
+
+        if (f->progress_current >= f->progress_next) {
+            imfile_update_progress(f);
+        }
+    }
+
+    return data;
+}
+
 int fscanf (IMFILE* f, const char* s ...);
 char* fgets (char* s, int n, IMFILE* f);
 
@@ -0,0 +1,56 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <glibmm/ustring.h>
+
+#include "procparams.h"
+
+namespace rtengine
+{
+
+/**
+ * The parameters of the last processing stages (resize, post-resize sharpening and output profile),
+ * which can differ between the outputs rendered from a single processing of an image.
+ */
+struct OutputSpec {
+    procparams::ResizeParams resize;
+    procparams::SharpeningParams prsharpening;
+    Glib::ustring outputProfile;
+    RenderingIntent outputIntent;
+    bool outputBPC;
+
+    explicit OutputSpec(const procparams::ProcParams& params) :
+        resize(params.resize),
+        prsharpening(params.prsharpening),
+        outputProfile(params.icm.outputProfile),
+        outputIntent(params.icm.outputIntent),
+        outputBPC(params.icm.outputBPC)
+    {
+    }
+
+    void applyTo(procparams::ProcParams& params) const
+    {
+        params.resize = resize;
+        params.prsharpening = prsharpening;
+        params.icm.outputProfile = outputProfile;
+        params.icm.outputIntent = outputIntent;
+        params.icm.outputBPC = outputBPC;
+    }
+};
+
+}
@@ -75,6 +75,28 @@ float nonGreenDiffCross(float right, float left, float top, float bottom, float
     return std::min(hDiff, vDiff) - stddev;
 }
 
+void fillNonGreenRow(int row, int xStart, int xEnd, const unsigned int cfa[2][2], const array2D<float> * const frames[4], const float ngbright[2][4], float *nonGreenDest0, float *nonGreenDest1)
+{
+    // store the non green values of one row from the 4 frames into 2 destination rows (red and blue)
+    int ng = 0;
+    const unsigned int c = fc(cfa, row, xStart);
+
+    if((c + fc(cfa, row, xStart + 1)) == 3) {
+        // row with blue pixels => swap destination pointers for non green pixels
+        std::swap(nonGreenDest0, nonGreenDest1);
+        ng ^= 1;
+    }
+
+    // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
+    unsigned int offset = c & 1;
+
+    for(int j = xStart; j < xEnd; ++j) {
+        nonGreenDest0[j] = (*frames[(offset << 1) + offset])[row][j + offset] * ngbright[ng][(offset << 1) + offset];
+        nonGreenDest1[j] = (*frames[2 - offset])[row + 1][j - offset + 1] * ngbright[ng ^ 1][2 - offset];
+        offset ^= 1; // 0 => 1 or 1 => 0
+    }
+}
+
 void paintMotionMask(int index, bool showMotion, float *maskDest, float *nonMaskDest0, float *nonMaskDest1)
 {
     if(showMotion) {
@@ -334,32 +356,32 @@ BENCHFUN
 
     if(motionDetection) {
         if(!showOnlyMask) {
-            if(bayerParams.pixelShiftMedian || bayerParams.pixelShiftAverage) { // We need the demosaiced frames for motion correction
-                if (bayerParams.pixelShiftDemosaicMethod == bayerParams.getPSDemosaicMethodString(procparams::RAWParams::BayerSensor::PSDemosaicMethod::LMMSE)) {
-                    lmmse_interpolate_omp(winw, winh, *(rawDataFrames[0]), red, green, blue, bayerParams.lmmse_iterations);
-                } else if (bayerParams.pixelShiftDemosaicMethod == bayerParams.getPSDemosaicMethodString(procparams::RAWParams::BayerSensor::PSDemosaicMethod::AMAZEVNG4)) {
-                    dual_demosaic_RT (true, rawParamsIn, winw, winh, *(rawDataFrames[0]), red, green, blue, bayerParams.dualDemosaicContrast, true);
-                } else if (bayerParams.pixelShiftDemosaicMethod == bayerParams.getPSDemosaicMethodString(procparams::RAWParams::BayerSensor::PSDemosaicMethod::RCDVNG4)) {
-                    dual_demosaic_RT (true, rawParamsIn, winw, winh, *(rawDataFrames[0]), red, green, blue, bayerParams.dualDemosaicContrast, true);
-                } else {
-                    amaze_demosaic_RT(winx, winy, winw, winh, *(rawDataFrames[0]), red, green, blue, options.chunkSizeAMAZE, options.measure);
-                }
-                multi_array2D<float, 3> redTmp(winw, winh);
-                multi_array2D<float, 3> greenTmp(winw, winh);
-                multi_array2D<float, 3> blueTmp(winw, winh);
-
-                for(int i = 0; i < 3; i++) {
+            const auto demosaicFrame =
+                [&](const array2D<float> &rawFrame, array2D<float> &redDest, array2D<float> &greenDest, array2D<float> &blueDest)
+                {
                     if (bayerParams.pixelShiftDemosaicMethod == bayerParams.getPSDemosaicMethodString(procparams::RAWParams::BayerSensor::PSDemosaicMethod::LMMSE)) {
-                        lmmse_interpolate_omp(winw, winh, *(rawDataFrames[i + 1]), redTmp[i], greenTmp[i], blueTmp[i], bayerParams.lmmse_iterations);
+                        lmmse_interpolate_omp(winw, winh, rawFrame, redDest, greenDest, blueDest, bayerParams.lmmse_iterations);
                     } else if (bayerParams.pixelShiftDemosaicMethod == bayerParams.getPSDemosaicMethodString(procparams::RAWParams::BayerSensor::PSDemosaicMethod::AMAZEVNG4)) {
-                        dual_demosaic_RT (true, rawParamsIn, winw, winh, *(rawDataFrames[i + 1]), redTmp[i], greenTmp[i], blueTmp[i], bayerParams.dualDemosaicContrast, true);
+                        dual_demosaic_RT (true, rawParamsIn, winw, winh, rawFrame, redDest, greenDest, blueDest, bayerParams.dualDemosaicContrast, true);
                     } else if (bayerParams.pixelShiftDemosaicMethod == bayerParams.getPSDemosaicMethodString(procparams::RAWParams::BayerSensor::PSDemosaicMethod::RCDVNG4)) {
-                        dual_demosaic_RT (true, rawParamsIn, winw, winh, *(rawDataFrames[i + 1]), redTmp[i], greenTmp[i], blueTmp[i], bayerParams.dualDemosaicContrast, true);
+                        dual_demosaic_RT (true, rawParamsIn, winw, winh, rawFrame, redDest, greenDest, blueDest, bayerParams.dualDemosaicContrast, true);
                     } else {
-                        amaze_demosaic_RT(winx, winy, winw, winh, *(rawDataFrames[i + 1]), redTmp[i], greenTmp[i], blueTmp[i], options.chunkSizeAMAZE, options.measure);
+                        amaze_demosaic_RT(winx, winy, winw, winh, rawFrame, redDest, greenDest, blueDest, options.chunkSizeAMAZE, options.measure);
                     }
-                }
+                };
+
+            if(bayerParams.pixelShiftMedian || bayerParams.pixelShiftAverage) { // We need the demosaiced frames for motion correction
+                demosaicFrame(*(rawDataFrames[0]), red, green, blue);
+
                 if(bayerParams.pixelShiftMedian) {
+                    // the median needs all 4 demosaiced frames at once
+                    multi_array2D<float, 3> redTmp(winw, winh);
+                    multi_array2D<float, 3> greenTmp(winw, winh);
+                    multi_array2D<float, 3> blueTmp(winw, winh);
+
+                    for(int i = 0; i < 3; i++) {
+                        demosaicFrame(*(rawDataFrames[i + 1]), redTmp[i], greenTmp[i], blueTmp[i]);
+                    }
 
 #ifdef _OPENMP
                     #pragma omp parallel for schedule(dynamic,16)
@@ -379,21 +401,37 @@ BENCHFUN
                         }
                     }
                 } else {
+                    // the average is accumulated one demosaiced frame at a time, so only one temporary frame is resident
+                    array2D<float> redTmp(winw, winh);
+                    array2D<float> greenTmp(winw, winh);
+                    array2D<float> blueTmp(winw, winh);
+
+                    // position of frames 1 to 3 relative to frame 0
+                    constexpr int frameOffsY[3] = {1, 1, 0};
+                    constexpr int frameOffsX[3] = {0, 1, 1};
+
+                    for(int f = 0; f < 3; f++) {
+                        demosaicFrame(*(rawDataFrames[f + 1]), redTmp, greenTmp, blueTmp);
+                        const int dy = frameOffsY[f];
+                        const int dx = frameOffsX[f];
+                        const float scale = f == 2 ? 0.25f : 1.f;
+
 #ifdef _OPENMP
-                    #pragma omp parallel for schedule(dynamic,16)
+                        #pragma omp parallel for schedule(dynamic,16)
 #endif
 
-                    for(int i = winy + border; i < winh - border; i++) {
-                        for(int j = winx + border; j < winw - border; j++) {
-                            red[i][j] = 0.25f * ((red[i][j] + redTmp[0][i + 1][j]) + (redTmp[1][i + 1][j + 1] + redTmp[2][i][j + 1]));
-                        }
+                        for(int i = winy + border; i < winh - border; i++) {
+                            for(int j = winx + border; j < winw - border; j++) {
+                                red[i][j] = scale * (red[i][j] + redTmp[i + dy][j + dx]);
+                            }
 
-                        for(int j = winx + border; j < winw - border; j++) {
-                            green[i][j] = 0.25f * ((green[i][j] + greenTmp[0][i + 1][j]) + (greenTmp[1][i + 1][j + 1] + greenTmp[2][i][j + 1]));
-                        }
+                            for(int j = winx + border; j < winw - border; j++) {
+                                green[i][j] = scale * (green[i][j] + greenTmp[i + dy][j + dx]);
+                            }
 
-                        for(int j = winx + border; j < winw - border; j++) {
-                            blue[i][j] = 0.25f * ((blue[i][j] + blueTmp[0][i + 1][j]) + (blueTmp[1][i + 1][j + 1] + blueTmp[2][i][j + 1]));
+                            for(int j = winx + border; j < winw - border; j++) {
+                                blue[i][j] = scale * (blue[i][j] + blueTmp[i + dy][j + dx]);
+                            }
                         }
                     }
                 }
@@ -743,46 +781,12 @@ BENCHFUN
 
 
     if(motionDetection) {
-        // fill channels psRed and psBlue
-        array2D<float> psRed(winw + 32, winh); // increase width to avoid cache conflicts
-        array2D<float> psBlue(winw + 32, winh);
-
-#ifdef _OPENMP
-        #pragma omp parallel for schedule(dynamic,16)
-#endif
-
-        for(int i = winy + 1; i < winh - 1; ++i) {
-            float *nonGreenDest0 = psRed[i];
-            float *nonGreenDest1 = psBlue[i];
-            float ngbright[2][4] = {{redBrightness[0], redBrightness[1], redBrightness[2], redBrightness[3]},
-                                    {blueBrightness[0], blueBrightness[1], blueBrightness[2], blueBrightness[3]}
-                                   };
-            int ng = 0;
-            int j = winx + 1;
-            int c = fc(cfarray, i, j);
-
-            if((c + fc(cfarray, i, j + 1)) == 3) {
-                // row with blue pixels => swap destination pointers for non green pixels
-                std::swap(nonGreenDest0, nonGreenDest1);
-                ng ^= 1;
-            }
-
-            // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
-            unsigned int offset = c & 1;
-
-            for(; j < winw - 1; ++j) {
-                // store the non green values from the 4 frames into 2 temporary planes
-                nonGreenDest0[j] = (*rawDataFrames[(offset << 1) + offset])[i][j + offset] * ngbright[ng][(offset << 1) + offset];
-                nonGreenDest1[j] = (*rawDataFrames[2 - offset])[i + 1][j - offset + 1] * ngbright[ng ^ 1][2 - offset];
-                offset ^= 1; // 0 => 1 or 1 => 0
-            }
-        }
-
-        if(plistener) {
-            plistener->setProgress(0.3);
-        }
+        // the non green values of the 4 frames are not stored in full size planes but computed band-wise when needed
+        const float ngbright[2][4] = {{redBrightness[0], redBrightness[1], redBrightness[2], redBrightness[3]},
+                                      {blueBrightness[0], blueBrightness[1], blueBrightness[2], blueBrightness[3]}
+                                     };
 
-        // now that the temporary planes are filled for easy access we do the motion detection
+        // now we do the motion detection
         array2D<float> psMask(winw, winh);
 
         int offsX = 0, offsY = 0;
@@ -810,50 +814,82 @@ BENCHFUN
         }
 
 
+        const int yStart = winy + border - offsY;
+        const int yEnd = winh - (border + offsY);
+
 #ifdef _OPENMP
-        #pragma omp parallel for schedule(dynamic,16)
+        #pragma omp parallel
 #endif
+        {
+            // band of non green values including one row above and below for the cross check.
+            // Columns outside the filled range stay zero
+            constexpr int bandHeight = 16;
+            array2D<float> psRed(winw + 32, bandHeight + 2, ARRAY2D_CLEAR_DATA); // increase width to avoid cache conflicts
+            array2D<float> psBlue(winw + 32, bandHeight + 2, ARRAY2D_CLEAR_DATA);
 
-        for(int i = winy + border - offsY; i < winh - (border + offsY); ++i) {
-            // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
-            unsigned int offset = fc(cfarray, i, winx + border - offsX) & 1;
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+#endif
 
-            for(int j = winx + border - offsX; j < winw - (border + offsX); ++j, offset ^= 1) {
-                psMask[i][j] = noMotion;
+            for(int bandStart = yStart; bandStart < yEnd; bandStart += bandHeight) {
+                const int bandEnd = std::min(bandStart + bandHeight, yEnd);
 
-                if(checkGreen) {
-                    if(greenDiff((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset], (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset], stddevFactorGreen, eperIsoGreen, nRead, prnu) > 0.f) {
-                        psMask[i][j] = greenWeight;
-                        // do not set the motion pixel values. They have already been set by demosaicer
-                        continue;
+                if(checkNonGreenCross) {
+                    for(int i = bandStart - 1; i <= bandEnd; ++i) {
+                        const int k = i - bandStart + 1;
+
+                        if(i > winy && i < winh - 1) {
+                            fillNonGreenRow(i, winx + 1, winw - 1, cfarray, rawDataFrames, ngbright, psRed[k], psBlue[k]);
+                        } else {
+                            std::fill(psRed[k], psRed[k] + winw + 32, 0.f);
+                            std::fill(psBlue[k], psBlue[k] + winw + 32, 0.f);
+                        }
                     }
                 }
 
-                if(checkNonGreenCross) {
-                    // check red cross
-                    float redTop    = psRed[i - 1][j];
-                    float redLeft   = psRed[i][j - 1];
-                    float redCentre = psRed[i][j];
-                    float redRight  = psRed[i][j + 1];
-                    float redBottom = psRed[i + 1][j];
-                    float redDiff   = nonGreenDiffCross(redRight, redLeft, redTop, redBottom, redCentre, clippedRed, stddevFactorRed, eperIsoRed, nRead, prnu);
-
-                    if(redDiff > 0.f) {
-                        psMask[i][j] = redBlueWeight;
-                        continue;
-                    }
+                for(int i = bandStart; i < bandEnd; ++i) {
+                    const int k = i - bandStart + 1;
+                    // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
+                    unsigned int offset = fc(cfarray, i, winx + border - offsX) & 1;
 
-                    // check blue cross
-                    float blueTop    = psBlue[i - 1][j];
-                    float blueLeft   = psBlue[i][j - 1];
-                    float blueCentre = psBlue[i][j];
-                    float blueRight  = psBlue[i][j + 1];
-                    float blueBottom = psBlue[i + 1][j];
-                    float blueDiff   = nonGreenDiffCross(blueRight, blueLeft, blueTop, blueBottom, blueCentre, clippedBlue, stddevFactorBlue, eperIsoBlue, nRead, prnu);
-
-                    if(blueDiff > 0.f) {
-                        psMask[i][j] = redBlueWeight;
-                        continue;
+                    for(int j = winx + border - offsX; j < winw - (border + offsX); ++j, offset ^= 1) {
+                        psMask[i][j] = noMotion;
+
+                        if(checkGreen) {
+                            if(greenDiff((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset], (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset], stddevFactorGreen, eperIsoGreen, nRead, prnu) > 0.f) {
+                                psMask[i][j] = greenWeight;
+                                // do not set the motion pixel values. They have already been set by demosaicer
+                                continue;
+                            }
+                        }
+
+                        if(checkNonGreenCross) {
+                            // check red cross
+                            float redTop    = psRed[k - 1][j];
+                            float redLeft   = psRed[k][j - 1];
+                            float redCentre = psRed[k][j];
+                            float redRight  = psRed[k][j + 1];
+                            float redBottom = psRed[k + 1][j];
+                            float redDiff   = nonGreenDiffCross(redRight, redLeft, redTop, redBottom, redCentre, clippedRed, stddevFactorRed, eperIsoRed, nRead, prnu);
+
+                            if(redDiff > 0.f) {
+                                psMask[i][j] = redBlueWeight;
+                                continue;
+                            }
+
+                            // check blue cross
+                            float blueTop    = psBlue[k - 1][j];
+                            float blueLeft   = psBlue[k][j - 1];
+                            float blueCentre = psBlue[k][j];
+                            float blueRight  = psBlue[k][j + 1];
+                            float blueBottom = psBlue[k + 1][j];
+                            float blueDiff   = nonGreenDiffCross(blueRight, blueLeft, blueTop, blueBottom, blueCentre, clippedBlue, stddevFactorBlue, eperIsoBlue, nRead, prnu);
+
+                            if(blueDiff > 0.f) {
+                                psMask[i][j] = redBlueWeight;
+                                continue;
+                            }
+                        }
                     }
                 }
             }
@@ -922,103 +958,103 @@ BENCHFUN
         }
 
 #ifdef _OPENMP
-        #pragma omp parallel for schedule(dynamic,16)
+        #pragma omp parallel
 #endif
+        {
+            std::vector<float> psRedRow(winw);
+            std::vector<float> psBlueRow(winw);
 
-        for(int i = winy + border - offsY; i < winh - (border + offsY); ++i) {
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic,16)
+#endif
+
+            for(int i = yStart; i < yEnd; ++i) {
 #ifdef __SSE2__
 
-            // pow() is expensive => pre calculate blend factor using SSE
-            if(smoothTransitions) { //
-                vfloat onev = F2V(1.f);
-                vfloat smoothv = F2V(smoothFactor);
-                int j = winx + border - offsX;
-
-                for(; j < winw - (border + offsX) - 3; j += 4) {
-                    vfloat blendv = vmaxf(LVFU(psMask[i][j]), onev) - onev;
-                    blendv = pow_F(blendv, smoothv);
-                    blendv = vself(vmaskf_eq(smoothv, ZEROV), onev, blendv);
-                    STVFU(psMask[i][j], blendv);
-                }
+                // pow() is expensive => pre calculate blend factor using SSE
+                if(smoothTransitions) { //
+                    vfloat onev = F2V(1.f);
+                    vfloat smoothv = F2V(smoothFactor);
+                    int j = winx + border - offsX;
+
+                    for(; j < winw - (border + offsX) - 3; j += 4) {
+                        vfloat blendv = vmaxf(LVFU(psMask[i][j]), onev) - onev;
+                        blendv = pow_F(blendv, smoothv);
+                        blendv = vself(vmaskf_eq(smoothv, ZEROV), onev, blendv);
+                        STVFU(psMask[i][j], blendv);
+                    }
 
-                for(; j < winw - (border + offsX); ++j) {
-                    psMask[i][j] = smoothFactor == 0.f ? 1.f : pow_F(std::max(psMask[i][j] - 1.f, 0.f), smoothFactor);
+                    for(; j < winw - (border + offsX); ++j) {
+                        psMask[i][j] = smoothFactor == 0.f ? 1.f : pow_F(std::max(psMask[i][j] - 1.f, 0.f), smoothFactor);
+                    }
                 }
-            }
 
 #endif
-            float *greenDest = green[i + offsY];
-            float *redDest = red[i + offsY];
-            float *blueDest = blue[i + offsY];
+                if(!showOnlyMask) {
+                    fillNonGreenRow(i, winx + 1, winw - 1, cfarray, rawDataFrames, ngbright, psRedRow.data(), psBlueRow.data());
+                }
 
-            // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
-            unsigned int offset = fc(cfarray, i, winx + border - offsX) & 1;
+                float *greenDest = green[i + offsY];
+                float *redDest = red[i + offsY];
+                float *blueDest = blue[i + offsY];
 
-            for(int j = winx + border - offsX; j < winw - (border + offsX); ++j, offset ^= 1) {
-                if(showOnlyMask) {
-                    if(smoothTransitions) { // we want only motion mask => paint areas according to their motion (dark = no motion, bright = motion)
+                // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
+                unsigned int offset = fc(cfarray, i, winx + border - offsX) & 1;
+
+                for(int j = winx + border - offsX; j < winw - (border + offsX); ++j, offset ^= 1) {
+                    if(showOnlyMask) {
+                        if(smoothTransitions) { // we want only motion mask => paint areas according to their motion (dark = no motion, bright = motion)
 #ifdef __SSE2__
-                        // use pre calculated blend factor
-                        const float blend = psMask[i][j];
+                            // use pre calculated blend factor
+                            const float blend = psMask[i][j];
 #else
-                        const float blend = smoothFactor == 0.f ? 1.f : pow_F(std::max(psMask[i][j] - 1.f, 0.f), smoothFactor);
+                            const float blend = smoothFactor == 0.f ? 1.f : pow_F(std::max(psMask[i][j] - 1.f, 0.f), smoothFactor);
 #endif
-                        redDest[j + offsX] = greenDest[j + offsX] = blueDest[j + offsX] = blend * 32768.f;
+                            redDest[j + offsX] = greenDest[j + offsX] = blueDest[j + offsX] = blend * 32768.f;
+                        } else {
+                            redDest[j + offsX] = greenDest[j + offsX] = blueDest[j + offsX] = mask[i][j] == 255 ? 65535.f : 0.f;
+                        }
+                    } else if(mask[i][j] == 255) {
+                        paintMotionMask(j + offsX, showMotion, greenDest, redDest, blueDest);
                     } else {
-                        redDest[j + offsX] = greenDest[j + offsX] = blueDest[j + offsX] = mask[i][j] == 255 ? 65535.f : 0.f;
-                    }
-                } else if(mask[i][j] == 255) {
-                    paintMotionMask(j + offsX, showMotion, greenDest, redDest, blueDest);
-                } else {
-                    if(smoothTransitions) {
+                        if(smoothTransitions) {
 #ifdef __SSE2__
-                        // use pre calculated blend factor
-                        const float blend = psMask[i][j];
+                            // use pre calculated blend factor
+                            const float blend = psMask[i][j];
 #else
-                        const float blend = smoothFactor == 0.f ? 1.f : pow_F(std::max(psMask[i][j] - 1.f, 0.f), smoothFactor);
+                            const float blend = smoothFactor == 0.f ? 1.f : pow_F(std::max(psMask[i][j] - 1.f, 0.f), smoothFactor);
 #endif
-                        redDest[j + offsX] = intp(blend, showMotion ? 0.f : redDest[j + offsX], psRed[i][j] );
-                        greenDest[j + offsX] = intp(blend, showMotion ? 13500.f : greenDest[j + offsX], ((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset] + (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset]) * 0.5f);
-                        blueDest[j + offsX] = intp(blend, showMotion ? 0.f : blueDest[j + offsX], psBlue[i][j]);
-                    } else {
-                        redDest[j + offsX] = psRed[i][j];
-                        greenDest[j + offsX] = ((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset] + (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset]) * 0.5f;
-                        blueDest[j + offsX] = psBlue[i][j];
+                            redDest[j + offsX] = intp(blend, showMotion ? 0.f : redDest[j + offsX], psRedRow[j] );
+                            greenDest[j + offsX] = intp(blend, showMotion ? 13500.f : greenDest[j + offsX], ((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset] + (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset]) * 0.5f);
+                            blueDest[j + offsX] = intp(blend, showMotion ? 0.f : blueDest[j + offsX], psBlueRow[j]);
+                        } else {
+                            redDest[j + offsX] = psRedRow[j];
+                            greenDest[j + offsX] = ((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset] + (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset]) * 0.5f;
+                            blueDest[j + offsX] = psBlueRow[j];
+                        }
                     }
                 }
             }
         }
     } else {
         // motion detection off => combine the 4 raw frames
-        float ngbright[2][4] = {{redBrightness[0], redBrightness[1], redBrightness[2], redBrightness[3]},
-                                {blueBrightness[0], blueBrightness[1], blueBrightness[2], blueBrightness[3]}
-        };
+        const float ngbright[2][4] = {{redBrightness[0], redBrightness[1], redBrightness[2], redBrightness[3]},
+                                      {blueBrightness[0], blueBrightness[1], blueBrightness[2], blueBrightness[3]}
+                                     };
 #ifdef _OPENMP
         #pragma omp parallel for schedule(dynamic,16)
 #endif
 
         for(int i = winy + 1; i < winh - 1; ++i) {
-            float *nonGreenDest0 = red[i];
-            float *nonGreenDest1 = blue[i];
-            int ng = 0;
-            int j = winx + 1;
-            int c = fc(cfarray, i, j);
-
-            if((c + fc(cfarray, i, j + 1)) == 3) {
-                // row with blue pixels => swap destination pointers for non green pixels
-                std::swap(nonGreenDest0, nonGreenDest1);
-                ng ^= 1;
-            }
+            // set red and blue values
+            fillNonGreenRow(i, winx + 1, winw - 1, cfarray, rawDataFrames, ngbright, red[i], blue[i]);
 
             // offset to keep the code short. It changes its value between 0 and 1 for each iteration of the loop
-            unsigned int offset = c & 1;
+            unsigned int offset = fc(cfarray, i, winx + 1) & 1;
 
-            for(; j < winw - 1; ++j) {
-                // set red, green and blue values
+            for(int j = winx + 1; j < winw - 1; ++j, offset ^= 1) {
+                // set green values
                 green[i][j] = ((*rawDataFrames[1 - offset])[i - offset + 1][j] * greenBrightness[1 - offset] + (*rawDataFrames[3 - offset])[i + offset][j + 1] * greenBrightness[3 - offset]) * 0.5f;
-                nonGreenDest0[j] = (*rawDataFrames[(offset << 1) + offset])[i][j + offset] * ngbright[ng][(offset << 1) + offset];
-                nonGreenDest1[j] = (*rawDataFrames[2 - offset])[i + 1][j - offset + 1] * ngbright[ng ^ 1][2 - offset];
-                offset ^= 1; // 0 => 1 or 1 => 0
             }
         }
     }
@@ -18,6 +18,9 @@
  */
 #pragma once
 
+#include <vector>
+
+#include "outputspec.h"
 #include "procparams.h"
 #include "rtengine.h"
 
@@ -33,6 +36,7 @@ public:
     InitialImage* initialImage;
     procparams::ProcParams pparams;
     bool fast;
+    std::vector<OutputSpec> extraOutputs;
 
     ProcessingJobImpl (const Glib::ustring& fn, bool iR, const procparams::ProcParams& pp, bool ff)
         : fname(fn), isRaw(iR), initialImage(nullptr), pparams(pp), fast(ff) {}
@@ -51,6 +55,7 @@ public:
     }
 
     bool fastPipeline() const override { return fast; }
+    void setExtraOutputs (const std::vector<OutputSpec>& outputs) override { extraOutputs = outputs; }
 };
 
 }
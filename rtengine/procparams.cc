@@ -17,7 +17,10 @@
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <functional>
+#include <list>
 #include <map>
+#include <memory>
 
 #include <locale.h>
 
@@ -35,6 +38,7 @@
 #include "../rtgui/multilangmgr.h"
 #include "../rtgui/options.h"
 #include "../rtgui/paramsedited.h"
+#include "../rtgui/threadutils.h"
 #include "../rtgui/ppversion.h"
 #include "../rtgui/version.h"
 
@@ -411,6 +415,182 @@ bool saveToKeyfile(
     return false;
 }
 
+/**
+  * Cache of parsed PP3 files, so that loading the same sidecar repeatedly (file browser, batch queue,
+  * dynamic profiles...) doesn't go through Glib::KeyFile each time.
+  *
+  * ProcParams::load only assigns the keys present in the file, so an entry is only valid for the
+  * same starting parameters: the parameters the file has been loaded into are stored along with the
+  * result. The entry is keyed by the file name, a hash and the size of its content (the modification
+  * time isn't precise enough to catch a file rewritten within the same second), and by the folders used
+  * to expand relative paths.
+  */
+class LoadCache
+{
+public:
+    bool lookup(const Glib::ustring& fname, const std::string& content, rtengine::procparams::ProcParams& params, ParamsEdited* pedited)
+    {
+        const std::size_t hash = std::hash<std::string>()(content);
+
+        MyMutex::MyLock lock(mutex);
+
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+            if (
+                entry->fname == fname
+                && entry->hash == hash
+                && entry->size == content.size()
+                && (entry->edited != nullptr) == (pedited != nullptr)
+                && entry->paths == getPaths()
+                && sameStart(entry->start, params)
+            ) {
+                params = entry->result;
+
+                if (pedited) {
+                    *pedited = *entry->edited;
+                }
+
+                entries.splice(entries.begin(), entries, entry);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void store(const Glib::ustring& fname, const std::string& content, const rtengine::procparams::ProcParams& start, const rtengine::procparams::ProcParams& result, const ParamsEdited* pedited)
+    {
+        MyMutex::MyLock lock(mutex);
+
+        remove(fname);
+
+        entries.push_front({
+            fname,
+            std::hash<std::string>()(content),
+            content.size(),
+            getPaths(),
+            start,
+            result,
+            pedited ? std::unique_ptr<ParamsEdited>(new ParamsEdited(*pedited)) : nullptr
+        });
+
+        if (entries.size() > maxEntries) {
+            entries.pop_back();
+        }
+    }
+
+    void invalidate(const Glib::ustring& fname)
+    {
+        MyMutex::MyLock lock(mutex);
+        remove(fname);
+    }
+
+    void clear()
+    {
+        MyMutex::MyLock lock(mutex);
+        entries.clear();
+    }
+
+private:
+    struct Entry {
+        Glib::ustring fname;
+        std::size_t hash;
+        std::size_t size;
+        std::vector<Glib::ustring> paths;
+        rtengine::procparams::ProcParams start;
+        rtengine::procparams::ProcParams result;
+        std::unique_ptr<ParamsEdited> edited;
+    };
+
+    static constexpr std::size_t maxEntries = 100;
+
+    static std::vector<Glib::ustring> getPaths()
+    {
+        return {
+            options.rtSettings.lensProfilesPath,
+            options.rtSettings.cameraProfilesPath,
+            options.rtSettings.darkFramesPath,
+            options.rtSettings.flatFieldsPath
+        };
+    }
+
+    // Every member, in the order of the declaration: loadFromKeyfile() keeps whatever the file doesn't set,
+    // including the version fields it branches on, so any difference can change the result.
+    // ProcParams::operator == leaves some of them out on purpose and can't be used here.
+    static bool sameStart(const rtengine::procparams::ProcParams& a, const rtengine::procparams::ProcParams& b)
+    {
+        return
+            a.toneCurve == b.toneCurve
+            && a.labCurve == b.labCurve
+            && a.retinex == b.retinex
+            && a.localContrast == b.localContrast
+            && a.rgbCurves == b.rgbCurves
+            && a.colorToning == b.colorToning
+            && a.sharpening == b.sharpening
+            && a.prsharpening == b.prsharpening
+            && a.pdsharpening == b.pdsharpening
+            && a.sharpenEdge == b.sharpenEdge
+            && a.sharpenMicro == b.sharpenMicro
+            && a.vibrance == b.vibrance
+            && a.wb == b.wb
+            && a.colorappearance == b.colorappearance
+            && a.defringe == b.defringe
+            && a.impulseDenoise == b.impulseDenoise
+            && a.dirpyrDenoise == b.dirpyrDenoise
+            && a.epd == b.epd
+            && a.fattal == b.fattal
+            && a.sh == b.sh
+            && a.toneEqualizer == b.toneEqualizer
+            && a.crop == b.crop
+            && a.coarse == b.coarse
+            && a.commonTrans == b.commonTrans
+            && a.rotate == b.rotate
+            && a.distortion == b.distortion
+            && a.lensProf == b.lensProf
+            && a.perspective == b.perspective
+            && a.gradient == b.gradient
+            && a.locallab == b.locallab
+            && a.pcvignette == b.pcvignette
+            && a.cacorrection == b.cacorrection
+            && a.vignetting == b.vignetting
+            && a.chmixer == b.chmixer
+            && a.blackwhite == b.blackwhite
+            && a.resize == b.resize
+            && a.spot == b.spot
+            && a.icm == b.icm
+            && a.raw == b.raw
+            && a.wavelet == b.wavelet
+            && a.dirpyrequalizer == b.dirpyrequalizer
+            && a.hsvequalizer == b.hsvequalizer
+            && a.filmSimulation == b.filmSimulation
+            && a.softlight == b.softlight
+            && a.dehaze == b.dehaze
+            && a.filmNegative == b.filmNegative
+            && a.rank == b.rank
+            && a.colorlabel == b.colorlabel
+            && a.inTrash == b.inTrash
+            && a.appVersion == b.appVersion
+            && a.ppVersion == b.ppVersion
+            && a.metadata == b.metadata
+            && a.exif == b.exif
+            && a.iptc == b.iptc;
+    }
+
+    void remove(const Glib::ustring& fname)
+    {
+        entries.remove_if(
+            [&fname](const Entry& entry)
+            {
+                return entry.fname == fname;
+            }
+        );
+    }
+
+    std::list<Entry> entries;
+    MyMutex mutex;
+};
+
+LoadCache loadCache;
+
 }
 
 namespace rtengine
@@ -7737,12 +7917,41 @@ int ProcParams::save(const Glib::ustring& fname, const Glib::ustring& fname2, bo
 
 int ProcParams::load(const Glib::ustring& fname, ParamsEdited* pedited)
 {
-    setlocale(LC_NUMERIC, "C");  // to set decimal point to "."
-
     if (fname.empty()) {
         return 1;
     }
 
+    // the content is read once, to look up the cache and to be parsed
+    std::string content;
+
+    try {
+        content = Glib::file_get_contents(fname);
+    } catch (const Glib::Error&) {
+        if (pedited) {
+            pedited->set(false);
+        }
+
+        return 1;
+    }
+
+    if (loadCache.lookup(fname, content, *this, pedited)) {
+        return 0;
+    }
+
+    const ProcParams start(*this);
+    const int error = loadFromKeyfile(fname, content, pedited);
+
+    if (!error) {
+        loadCache.store(fname, content, start, *this, pedited);
+    }
+
+    return error;
+}
+
+int ProcParams::loadFromKeyfile(const Glib::ustring& fname, const std::string& content, ParamsEdited* pedited)
+{
+    setlocale(LC_NUMERIC, "C");  // to set decimal point to "."
+
     Glib::KeyFile keyFile;
 
     try {
@@ -7750,8 +7959,7 @@ int ProcParams::load(const Glib::ustring& fname, ParamsEdited* pedited)
             pedited->set(false);
         }
 
-        if (!Glib::file_test(fname, Glib::FILE_TEST_EXISTS) ||
-                !keyFile.load_from_file(fname)) {
+        if (!keyFile.load_from_data(content)) {
             return 1;
         }
 
@@ -10706,6 +10914,7 @@ void ProcParams::init()
 
 void ProcParams::cleanup()
 {
+    loadCache.clear();
 }
 
 int ProcParams::write(const Glib::ustring& fname, const Glib::ustring& content) const
@@ -10713,6 +10922,8 @@ int ProcParams::write(const Glib::ustring& fname, const Glib::ustring& content)
     int error = 0;
 
     if (fname.length()) {
+        loadCache.invalidate(fname);
+
         FILE *f;
         f = g_fopen(fname.c_str(), "wt");
 
@@ -22,6 +22,7 @@
 #include <cmath>
 #include <cstdio>
 #include <map>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -2615,6 +2616,7 @@ public:
     MetaDataParams          metadata;        ///< Metadata parameters
     ExifPairs               exif;            ///< List of modifications appplied on the exif tags of the input image
     IPTCPairs               iptc;            ///< The IPTC tags and values to be saved to the output image
+    // A new member has to be added to LoadCache::sameStart() in procparams.cc too
 
     /**
       * The constructor only sets the hand-wired defaults.
@@ -2636,7 +2638,8 @@ public:
       */
     int save(const Glib::ustring& fname, const Glib::ustring& fname2 = Glib::ustring(), bool fnameAbsolute = true, ParamsEdited* pedited = nullptr);
     /**
-      * Loads the parameters from a file.
+      * Loads the parameters from a file. Parsed files are cached, so loading an unchanged file again
+      * into the same parameters doesn't parse it again.
       * @param fname the name of the file
       * @params pedited pointer to a ParamsEdited object (optional) to store which values has been loaded
       * @return Error code (=0 if no error)
@@ -2658,6 +2661,14 @@ public:
     bool operator !=(const ProcParams& other) const;
 
 private:
+    /** Parses the content of the file of the given name, bypassing the cache of loaded files.
+    * @param fname the name of the file, used to expand the relative paths
+    * @param content the content of the file
+    * @param pedited pointer to a ParamsEdited object (optional) to store which values has been loaded
+    * @return Error code (=0 if no error)
+    * */
+    int loadFromKeyfile(const Glib::ustring& fname, const std::string& content, ParamsEdited* pedited);
+
     /** Write the ProcParams's text in the file of the given name.
     * @param fname the name of the file
     * @param content the text to write
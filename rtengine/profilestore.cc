@@ -18,10 +18,13 @@
  */
 
 #include <algorithm>
+#include <functional>
 #include <map>
 
 #include <glibmm/fileutils.h>
+#include <glibmm/keyfile.h>
 #include <glibmm/miscutils.h>
+#include <glibmm/thread.h>
 
 #include "profilestore.h"
 
@@ -34,7 +37,7 @@
 using namespace rtengine;
 using namespace rtengine::procparams;
 
-ProfileStore::ProfileStore () : storeState (STORESTATE_NOTINITIALIZED), internalDefaultProfile (nullptr), internalDefaultEntry (nullptr), internalDynamicEntry (nullptr), loadAll (true)
+ProfileStore::ProfileStore () : storeState (STORESTATE_NOTINITIALIZED), internalDefaultProfile (nullptr), internalDefaultEntry (nullptr), internalDynamicEntry (nullptr), indexChecked (false), checkThread (nullptr), abortCheck (false), loadAll (true)
 {
     internalDefaultProfile = new AutoPartialProfile();
     internalDefaultProfile->set (true);
@@ -53,24 +56,40 @@ bool ProfileStore::init (bool loadAll)
         return false;
     }
 
+    // the lightweight (command line) initialization loads the store upon first request, and needs it right away
+    const bool startup = storeState == STORESTATE_NOTINITIALIZED && this->loadAll;
     this->loadAll = loadAll;
 
     if ((storeState == STORESTATE_NOTINITIALIZED || storeState == STORESTATE_DIRTY) && loadAll) {
-        storeState = STORESTATE_BEINGINITIALIZED;
-        _parseProfiles ();
-        std::stable_partition(entries.begin(), entries.end(), [](const ProfileStoreEntry *e) { return e->type == PSET_FOLDER; });
-        storeState = STORESTATE_INITIALIZED;
+        // at startup, the profiles are listed from the index of the previous session without accessing
+        // the folders, which are scanned in the background; an explicit rescan is done right away
+        const bool fromIndex = startup && loadProfileIndex ();
+        buildProfileList (!fromIndex);
+
+        if (fromIndex) {
+            startIndexCheck ();
+        }
     }
 
     return storeState == STORESTATE_INITIALIZED;
 }
 
+void ProfileStore::buildProfileList (bool scan)
+{
+    storeState = STORESTATE_BEINGINITIALIZED;
+    _parseProfiles (scan);
+    std::stable_partition(entries.begin(), entries.end(), [](const ProfileStoreEntry *e) { return e->type == PSET_FOLDER; });
+    storeState = STORESTATE_INITIALIZED;
+}
+
 ProfileStore::~ProfileStore ()
 {
     if (storeState == STORESTATE_NOTINITIALIZED) {
         return;
     }
 
+    stopIndexCheck ();
+
     // This lock prevent object's suppression while scanning the directories
     storeState = STORESTATE_DELETED;
 
@@ -117,7 +136,39 @@ void ProfileStore::parseProfiles ()
     parseProfilesOnce ();
 }
 
-void ProfileStore::_parseProfiles ()
+void ProfileStore::updateIfChanged ()
+{
+    {
+        MyMutex::MyLock lock (indexMutex);
+
+        if (!indexChecked) {
+            return;
+        }
+
+        profileIndex = std::move (checkedIndex);
+        checkedIndex.clear ();
+        indexChecked = false;
+    }
+
+    // the check is over, or about to be
+    stopIndexCheck ();
+
+    for (auto listener : listeners) {
+        listener->storeCurrentValue();
+    }
+
+    {
+        MyMutex::MyLock lock (parseMutex);
+        buildProfileList (false);
+    }
+
+    for (auto listener : listeners) {
+        listener->updateProfileList();
+        listener->restoreValue();
+    }
+}
+
+void ProfileStore::_parseProfiles (bool scan)
 {
     // clear loaded profiles
     folders.clear();
@@ -126,21 +177,55 @@ void ProfileStore::_parseProfiles ()
 
     folders.push_back ("<<< ROOT >>>"); // Fake path, so parentFolderId == 0 will be used to attach a ProfileStoreEntry to the root container, not sub-menu
 
-    Glib::ustring p1 = options.getUserProfilePath();
-    Glib::ustring p2 = options.getGlobalProfilePath();
-    bool displayLevel0 = options.useBundledProfiles && !p1.empty() && !p2.empty() && p1 != p2;
+    bool displayLevel0;
+    const ProfileRoots roots = getRoots (displayLevel0);
 
-    Glib::ustring virtualPath;
-    Glib::ustring currDir;
-    if (!p1.empty()) {
-        virtualPath = "${U}";
-        currDir = "${U}";
-        parseDir (p1, virtualPath, currDir, 0, 0, displayLevel0);
+    if (scan) {
+        stopIndexCheck ();
+
+        ProfileIndex index;
+
+        for (const auto& root : roots) {
+            scanDir (root.first, root.second, profileIndex, index);
+        }
+
+        profileIndex = std::move (index);
+        saveProfileIndex (profileIndex, getRootsKey (roots, displayLevel0));
     }
-    if (p1.empty() || displayLevel0) {
-        virtualPath = "${G}";
-        currDir = "${G}";
-        parseDir (p2, virtualPath, currDir, 0, 0, displayLevel0);
+
+    // the folders are only listed if they contain a profile, directly or in a sub-folder
+    const std::function<unsigned int (const Glib::ustring&)> getFolderId =
+        [this, displayLevel0, &getFolderId] (const Glib::ustring& virtualPath) -> unsigned int
+        {
+            const int id = findFolderId (virtualPath);
+
+            if (id != -1) {
+                return id;
+            }
+
+            const bool isRoot = virtualPath == "${U}" || virtualPath == "${G}" || Glib::path_get_dirname (virtualPath) == virtualPath;
+            const unsigned int parentId = isRoot ? 0 : getFolderId (Glib::path_get_dirname (virtualPath));
+
+            folders.push_back (virtualPath);
+            const unsigned int folder = folders.size() - 1;
+
+            if (!isRoot) {
+                entries.push_back (new ProfileStoreEntry (Glib::path_get_basename (virtualPath), PSET_FOLDER, parentId, folder));
+            } else if (displayLevel0) {
+                // replace the virtual folder name by a localized text
+                entries.push_back (new ProfileStoreEntry (virtualPath == "${U}" ? M ("PROFILEPANEL_MYPROFILES") : M ("PROFILEPANEL_GLOBALPROFILES"), PSET_FOLDER, parentId, folder));
+            }
+
+            return folder;
+        };
+
+    for (const auto& file : profileIndex) {
+        if (file.second.valid) {
+            const Glib::ustring name = Glib::path_get_basename (file.first);
+            ProfileStoreEntry* const filePSE = new ProfileStoreEntry (name.substr (0, name.length() - 4), PSET_FILE, getFolderId (file.second.folder), 0);
+            entries.push_back (filePSE);
+            profileFiles[filePSE] = file.first;
+        }
     }
 
     // sort profiles
@@ -177,95 +262,220 @@ void ProfileStore::_parseProfiles ()
     }
 }
 
-/// @return Returns true if some files has been found (directories are ignored)
-bool ProfileStore::parseDir (Glib::ustring& realPath, Glib::ustring& virtualPath, Glib::ustring& currDir, unsigned int parentId, unsigned char level, bool displayLevel0)
+void ProfileStore::scanDir (const Glib::ustring& realPath, const Glib::ustring& virtualPath, const ProfileIndex& oldIndex, ProfileIndex& index) const
 {
-    bool fileFound = false;
+    if (realPath.empty() || !Glib::file_test (realPath, Glib::FILE_TEST_IS_DIR)) {
+        return;
+    }
 
-    // reload the available profiles from the profile dir
-    if (!realPath.empty() && Glib::file_test (realPath, Glib::FILE_TEST_EXISTS) && Glib::file_test (realPath, Glib::FILE_TEST_IS_DIR)) {
-        unsigned int folder = 0; // folder's own Id
+    try {
+        Glib::Dir dir (realPath);
 
-        // add this entry to the folder list
-        folders.push_back (virtualPath);
-        folder = (unsigned int) (folders.size()) - 1;
+        for (Glib::DirIterator i = dir.begin(); i != dir.end() && !abortCheck; ++i) {
+            const Glib::ustring currDir = *i;
+            const Glib::ustring fname = Glib::build_filename (realPath, currDir);
 
-        if (level > 0 || displayLevel0) {
-            // replace the virtual folder name by a localized text
-            if (currDir == "${U}") {
-                currDir = M ("PROFILEPANEL_MYPROFILES");
-            } else if (currDir == "${G}") {
-                currDir = M ("PROFILEPANEL_GLOBALPROFILES");
+            if (Glib::file_test (fname, Glib::FILE_TEST_IS_DIR)) {
+                scanDir (fname, Glib::build_filename (virtualPath, currDir), oldIndex, index);
+                continue;
             }
 
-            // add this localized text to the file list
-            entries.push_back ( new ProfileStoreEntry (currDir, PSET_FOLDER, parentId, folder) );
-        }
+            const size_t lastdot = currDir.find_last_of ('.');
+
+            if (lastdot == Glib::ustring::npos || lastdot != currDir.length() - 4 || currDir.substr (lastdot).casefold() != paramFileExtension) {
+                continue;
+            }
 
-        // walking through the directory
-        Glib::Dir* dir = new Glib::Dir (realPath);
+            if (settings->verbose) {
+                printf ("Processing file %s...", fname.c_str());
+            }
 
-        for (Glib::DirIterator i = dir->begin(); i != dir->end(); ++i) {
-            currDir = *i;
+            std::string content;
+
+            try {
+                content = Glib::file_get_contents (fname);
+            } catch (const Glib::Error&) {
+                if (settings->verbose) {
+                    printf ("failed!\n");
+                }
 
-            if (currDir == "." || currDir == "..") {
                 continue;
             }
 
-            Glib::ustring fname = Glib::build_filename (realPath, currDir);
+            // the file is only parsed if its content changed since the previous scan
+            const std::size_t hash = std::hash<std::string>() (content);
+            const ProfileIndex::const_iterator iter = oldIndex.find (fname);
+            bool valid;
 
-            if (Glib::file_test (fname, Glib::FILE_TEST_IS_DIR)) {
-                Glib::ustring vp (Glib::build_filename (virtualPath, currDir));
-                Glib::ustring rp (Glib::build_filename (realPath,    currDir));
-                fileFound = parseDir (rp, vp, currDir, folder, level + 1, 0);
+            if (iter != oldIndex.end() && iter->second.hash == hash && iter->second.size == static_cast<gint64> (content.size())) {
+                valid = iter->second.valid;
             } else {
-                size_t lastdot = currDir.find_last_of ('.');
+                AutoPartialProfile prof;
+                valid = !prof.load (fname) && prof.pparams->ppVersion >= 220;
+            }
+
+            index[fname] = {virtualPath, hash, static_cast<gint64> (content.size()), valid};
+
+            if (settings->verbose) {
+                printf (valid ? "OK\n" : "failed!\n");
+            }
+        }
+    } catch (const Glib::Error& e) {
+        if (settings->verbose) {
+            printf ("Error scanning the profile folder \"%s\": %s\n", realPath.c_str(), e.what().c_str());
+        }
+    }
+}
+
+ProfileStore::ProfileRoots ProfileStore::getRoots (bool& displayLevel0)
+{
+    const Glib::ustring p1 = options.getUserProfilePath();
+    const Glib::ustring p2 = options.getGlobalProfilePath();
+    displayLevel0 = options.useBundledProfiles && !p1.empty() && !p2.empty() && p1 != p2;
 
-                if (lastdot != Glib::ustring::npos && lastdot == currDir.length() - 4 && currDir.substr (lastdot).casefold() == paramFileExtension) {
-                    // file found
-                    if (settings->verbose) {
-                        printf ("Processing file %s...", fname.c_str());
-                    }
+    ProfileRoots roots;
 
-                    Glib::ustring name = currDir.substr (0, lastdot);
+    if (!p1.empty()) {
+        roots.emplace_back (p1, "${U}");
+    }
 
-                    // create the partial profile
-                    AutoPartialProfile *pProf = new AutoPartialProfile();
-                    int res = pProf->load (fname);
+    if (p1.empty() || displayLevel0) {
+        roots.emplace_back (p2, "${G}");
+    }
 
-                    if (!res && pProf->pparams->ppVersion >= 220) {
-                        fileFound = true;
+    return roots;
+}
 
-                        if (settings->verbose) {
-                            printf ("OK\n");
-                        }
+Glib::ustring ProfileStore::getRootsKey (const ProfileRoots& roots, bool displayLevel0)
+{
+    Glib::ustring key = displayLevel0 ? "1" : "0";
 
-                        // adding this file to the list
-                        ProfileStoreEntry* filePSE = new ProfileStoreEntry (name, PSET_FILE, folder, 0);
-                        entries.push_back (filePSE);
+    for (const auto& root : roots) {
+        key += "|" + root.second + "=" + root.first;
+    }
 
-                        // map the partial profile
-                        partProfiles[filePSE] = pProf;
-                        //partProfiles.insert( std::pair<ProfileStoreEntry*, rtengine::procparams::AutoPartialProfile*> (filePSE, pProf) );
-                    } else if (settings->verbose) {
-                        printf ("failed!\n");
-                    }
-                }
+    return key;
+}
+
+bool ProfileStore::loadProfileIndex ()
+{
+    profileIndex.clear();
+
+    const Glib::ustring fname = Glib::build_filename (Options::cacheBaseDir, "profiles.index");
+
+    if (!Glib::file_test (fname, Glib::FILE_TEST_EXISTS)) {
+        return false;
+    }
+
+    bool displayLevel0;
+    const Glib::ustring rootsKey = getRootsKey (getRoots (displayLevel0), displayLevel0);
+
+    try {
+        Glib::KeyFile keyFile;
+
+        // an index made for other folders, or by an older version, is of no use
+        if (!keyFile.load_from_file (fname) || !keyFile.has_key ("General", "Roots") || keyFile.get_string ("General", "Roots") != rootsKey) {
+            return false;
+        }
+
+        for (const auto& group : keyFile.get_groups()) {
+            if (group != "General") {
+                profileIndex[keyFile.get_string (group, "Path")] = {
+                    keyFile.get_string (group, "Folder"),
+                    static_cast<std::size_t> (keyFile.get_uint64 (group, "Hash")),
+                    keyFile.get_int64 (group, "Size"),
+                    keyFile.get_boolean (group, "Valid")
+                };
             }
         }
+    } catch (const Glib::Error& e) {
+        if (settings->verbose) {
+            printf ("Error loading the profile index: %s\n", e.what().c_str());
+        }
+
+        profileIndex.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void ProfileStore::saveProfileIndex (const ProfileIndex& index, const Glib::ustring& rootsKey) const
+{
+    try {
+        Glib::KeyFile keyFile;
+        keyFile.set_string ("General", "Roots", rootsKey);
+        unsigned int i = 0;
+
+        for (const auto& entry : index) {
+            const Glib::ustring group = Glib::ustring::format ("Profile", i++);
+            keyFile.set_string (group, "Path", entry.first);
+            keyFile.set_string (group, "Folder", entry.second.folder);
+            keyFile.set_uint64 (group, "Hash", entry.second.hash);
+            keyFile.set_int64 (group, "Size", entry.second.size);
+            keyFile.set_boolean (group, "Valid", entry.second.valid);
+        }
+
+        keyFile.save_to_file (Glib::build_filename (Options::cacheBaseDir, "profiles.index"));
+    } catch (const Glib::Error& e) {
+        if (settings->verbose) {
+            printf ("Error saving the profile index: %s\n", e.what().c_str());
+        }
+    }
+}
 
-        delete dir;
+void ProfileStore::startIndexCheck ()
+{
+    bool displayLevel0;
+    checkRoots = getRoots (displayLevel0);
+    checkRootsKey = getRootsKey (checkRoots, displayLevel0);
+    abortCheck = false;
+
+    checkThread = Glib::Thread::create (sigc::mem_fun (*this, &ProfileStore::checkIndex), 0, true, true, Glib::THREAD_PRIORITY_LOW);
+}
+
+void ProfileStore::checkIndex ()
+{
+    // profileIndex is only replaced once this thread has been joined
+    ProfileIndex index;
+
+    for (const auto& root : checkRoots) {
+        scanDir (root.first, root.second, profileIndex, index);
     }
 
-    if (!fileFound && (level > 0 || displayLevel0)) {
-        // no files found in this level, we delete the subdirectory entry
-        folders.pop_back();
+    if (abortCheck || index == profileIndex) {
+        return;
+    }
+
+    saveProfileIndex (index, checkRootsKey);
+
+    {
+        MyMutex::MyLock lock (indexMutex);
+        checkedIndex = std::move (index);
+        indexChecked = true;
+    }
+
+    MyMutex::MyLock lock (listenersMutex);
+
+    for (auto listener : listeners) {
+        listener->profileFilesChanged();
+    }
+}
 
-        delete entries.back();
-        entries.pop_back();
+void ProfileStore::stopIndexCheck ()
+{
+    if (checkThread) {
+        abortCheck = true;
+        checkThread->join();
+        checkThread = nullptr;
     }
 
-    return fileFound;
+    abortCheck = false;
+
+    // a result not listed yet is outdated by whatever stops the check
+    MyMutex::MyLock lock (indexMutex);
+    checkedIndex.clear ();
+    indexChecked = false;
 }
 
 int ProfileStore::findFolderId (const Glib::ustring &path) const
@@ -390,13 +600,29 @@ const PartialProfile* ProfileStore::getProfile (const ProfileStoreEntry* entry)
 
     if (iter != partProfiles.end()) {
         return iter->second;
-    } else {
-        // This shouldn't happen!
-#ifndef NDEBUG
-        printf ("WARNING! Profile not found!\n");
-#endif
+    }
+
+    // the profile is loaded upon first request
+    const std::map<const ProfileStoreEntry*, Glib::ustring>::const_iterator file = profileFiles.find (entry);
+
+    if (file != profileFiles.end()) {
+        AutoPartialProfile *pProf = new AutoPartialProfile();
+
+        if (!pProf->load (file->second) && pProf->pparams->ppVersion >= 220) {
+            partProfiles[entry] = pProf;
+            return pProf;
+        }
+
+        delete pProf;
+        printf ("ERROR loading profile \"%s\"\n", file->second.c_str());
         return nullptr;
     }
+
+    // This shouldn't happen!
+#ifndef NDEBUG
+    printf ("WARNING! Profile not found!\n");
+#endif
+    return nullptr;
 }
 
 /** @brief Get a pointer to the profile's vector list
@@ -477,6 +703,7 @@ void ProfileStore::clearFileList()
     }
 
     entries.clear();
+    profileFiles.clear();
 }
 
 void ProfileStore::clearProfileList()
@@ -492,11 +719,13 @@ void ProfileStore::clearProfileList()
 
 void ProfileStore::addListener (ProfileStoreListener *listener)
 {
+    MyMutex::MyLock lock (listenersMutex);
     listeners.push_back (listener);
 }
 
 void ProfileStore::removeListener (ProfileStoreListener *listener)
 {
+    MyMutex::MyLock lock (listenersMutex);
     listeners.remove (listener);
 }
 
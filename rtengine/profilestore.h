@@ -18,8 +18,10 @@
  */
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include <glibmm/ustring.h>
@@ -29,6 +31,13 @@
 #include "../rtgui/threadutils.h"
 
 // forward decl
+namespace Glib
+{
+
+class Thread;
+
+}
+
 namespace rtengine
 {
 
@@ -62,6 +71,9 @@ public:
     virtual void updateProfileList() = 0;
     /** @brief Called whenever the profile list has changed and the old value have to be restored (if possible). */
     virtual void restoreValue() = 0;
+    /** @brief Called from a background thread when the profile files differ from the listed ones,
+      * ProfileStore::updateIfChanged() has to be called from the GUI thread to update the list. */
+    virtual void profileFilesChanged() {}
 };
 
 /// @brief ProfileStoreEntry type (folder or file)
@@ -154,29 +166,80 @@ private:
     /** List of the client of this store */
     std::list<ProfileStoreListener*> listeners;
 
+    /** Full path of the file of each profile entry; the PartialProfile is only loaded upon first request */
+    std::map<const ProfileStoreEntry*, Glib::ustring> profileFiles;
+
+    /** Entry of the profile index, telling whether a profile file was valid when it had the given content */
+    struct IndexEntry {
+        Glib::ustring folder; /// virtual path of the folder of the file, e.g. ${U}/Portraits
+        std::size_t hash;     /// hash of the content of the file
+        gint64 size;          /// size of the content of the file
+        bool valid;
+
+        bool operator ==(const IndexEntry& other) const
+        {
+            return folder == other.folder && hash == other.hash && size == other.size && valid == other.valid;
+        }
+    };
+
+    using ProfileIndex = std::map<Glib::ustring, IndexEntry>;
+    using ProfileRoots = std::vector<std::pair<Glib::ustring, Glib::ustring>>;
+
+    /** Index of the profile files by full path, kept in the cache folder: the list is built from it, and it
+      * is checked against the files when they are scanned, so that unchanged files don't have to be parsed */
+    ProfileIndex profileIndex;
+
+    /** Result of the background check of the index, listed by updateIfChanged(); guarded by indexMutex */
+    ProfileIndex checkedIndex;
+    bool indexChecked;
+    MyMutex indexMutex;
+
+    /** Background check of the index loaded at startup, see startIndexCheck() */
+    Glib::Thread* checkThread;
+    std::atomic<bool> abortCheck;
+    ProfileRoots checkRoots;
+    Glib::ustring checkRootsKey;
+
+    /** Guards the list of listeners, which are also called from the background check */
+    MyMutex listenersMutex;
+
     /** whereas we have to load all profile at init time or one by one upon request */
     bool loadAll;
 
-    /** @brief Method to recursively parse a profile folder with a level depth arbitrarily limited to 3
+    /** @brief Method to recursively scan a profile folder and index its profile files
       *
       * @param realPath       current full path of the scanned directory ; e.g.:  ~/MyProfiles/
       * @param virtualPath    current full path that will be saved in "options" ; must start with either ${U} or ${G},
       *                       standing for User's and Global's (RT) profile folder, respectively
-      * @param currDir        name of the directory to scan; it's the last element of the virtualPath
-      * @param parentId       path entry of the parent folder
-      * @param level          current level of the directory tree
-      * @param displayLevel0  if true, level 0 is created in order to have a User's and Bundled profiles separation (i.e. 2 root directories are expected)
-      *                       if false, only one root directory is expected
+      * @param oldIndex       index of the previous scan, the files whose content didn't change aren't parsed again
+      * @param index          index to which the profile files are added
       */
-    bool parseDir (Glib::ustring& realPath, Glib::ustring& virtualPath, Glib::ustring& currDir, unsigned int parentId, unsigned char level, bool displayLevel0);
+    void scanDir (const Glib::ustring& realPath, const Glib::ustring& virtualPath, const ProfileIndex& oldIndex, ProfileIndex& index) const;
     /** @brief Will parse the profiles's dir only once. Subsequent call to this function will be ignored unless the profile list has been cleared
      */
     void parseProfilesOnce ();
-    /** @brief Will scan the directory to fill the profile list
-     */
-    void _parseProfiles ();
+    /** @brief Fill the profile list from the profile index
+      *
+      * @param scan  if true, the folders are scanned first to update the index
+      */
+    void _parseProfiles (bool scan);
+    /** @brief Same as _parseProfiles(), with the store marked as being initialized meanwhile */
+    void buildProfileList (bool scan);
     void clearFileList ();
     void clearProfileList ();
+
+    /** @return the folders to scan, as (real path, virtual path) pairs */
+    static ProfileRoots getRoots (bool& displayLevel0);
+    static Glib::ustring getRootsKey (const ProfileRoots& roots, bool displayLevel0);
+
+    /** @return true if the index of the previous session has been loaded, and was made for the current folders */
+    bool loadProfileIndex ();
+    void saveProfileIndex (const ProfileIndex& index, const Glib::ustring& rootsKey) const;
+
+    /** @brief Scan the folders in a background thread, and tell the listeners if the files differ from the listed ones */
+    void startIndexCheck ();
+    void checkIndex ();
+
     const ProfileStoreEntry* findEntryFromFullPathU (Glib::ustring path);
 
 public:
@@ -188,6 +251,10 @@ public:
 
     bool init (bool loadAll = true);
     void parseProfiles ();
+    /** @brief Update the list from the background check of the index, if it found changes; to be called from the GUI thread */
+    void updateIfChanged ();
+    /** @brief Stop the background check of the index, if still running */
+    void stopIndexCheck ();
     int findFolderId (const Glib::ustring &path) const;
     const ProfileStoreEntry*                     findEntryFromFullPath (Glib::ustring path);
     const rtengine::procparams::PartialProfile*  getProfile (Glib::ustring path);
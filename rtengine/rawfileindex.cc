@@ -0,0 +1,185 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <memory>
+
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/keyfile.h>
+#include <glibmm/miscutils.h>
+
+#include "rawfileindex.h"
+
+#include "imagedata.h"
+#include "rawimage.h"
+#include "settings.h"
+
+#include "../rtgui/options.h"
+
+namespace rtengine
+{
+
+RawFileIndex::RawFileIndex(const Glib::ustring& indexName) :
+    indexName(indexName),
+    dirty(false)
+{
+}
+
+void RawFileIndex::load(const Glib::ustring& folder)
+{
+    this->folder = folder;
+    entries.clear();
+    dirty = false;
+
+    const Glib::ustring fname = Glib::build_filename(Options::cacheBaseDir, indexName);
+
+    if (!Glib::file_test(fname, Glib::FILE_TEST_EXISTS)) {
+        return;
+    }
+
+    try {
+        Glib::KeyFile keyFile;
+
+        if (!keyFile.load_from_file(fname) || !keyFile.has_group("General") || keyFile.get_string("General", "Folder") != folder) {
+            return;
+        }
+
+        for (const auto& group : keyFile.get_groups()) {
+            if (group == "General") {
+                continue;
+            }
+
+            Entry& entry = entries[keyFile.get_string(group, "Path")];
+            entry.mtime = keyFile.get_int64(group, "MTime");
+            entry.size = keyFile.get_int64(group, "Size");
+            entry.isRaw = keyFile.get_boolean(group, "IsRaw");
+            entry.seen = false;
+
+            if (entry.isRaw) {
+                entry.info.make = keyFile.get_string(group, "Make");
+                entry.info.model = keyFile.get_string(group, "Model");
+                entry.info.lens = keyFile.get_string(group, "Lens");
+                entry.info.iso = keyFile.get_integer(group, "ISO");
+                entry.info.shutter = keyFile.get_double(group, "Shutter");
+                entry.info.focalLength = keyFile.get_double(group, "FocalLength");
+                entry.info.fnumber = keyFile.get_double(group, "FNumber");
+                entry.info.timestamp = keyFile.get_int64(group, "Timestamp");
+                entry.info.rawTimestamp = keyFile.get_int64(group, "RawTimestamp");
+            }
+        }
+    } catch (const Glib::Error& e) {
+        if (settings->verbose) {
+            printf("Error loading %s: %s\n", fname.c_str(), e.what().c_str());
+        }
+
+        entries.clear();
+    }
+}
+
+void RawFileIndex::save()
+{
+    for (auto iter = entries.begin(); iter != entries.end();) {
+        if (iter->second.seen) {
+            ++iter;
+        } else {
+            iter = entries.erase(iter);
+            dirty = true;
+        }
+    }
+
+    if (!dirty) {
+        return;
+    }
+
+    const Glib::ustring fname = Glib::build_filename(Options::cacheBaseDir, indexName);
+
+    try {
+        Glib::KeyFile keyFile;
+        keyFile.set_string("General", "Folder", folder);
+
+        unsigned int i = 0;
+
+        for (const auto& entry : entries) {
+            const Glib::ustring group = Glib::ustring::format("File", i++);
+            keyFile.set_string(group, "Path", entry.first);
+            keyFile.set_int64(group, "MTime", entry.second.mtime);
+            keyFile.set_int64(group, "Size", entry.second.size);
+            keyFile.set_boolean(group, "IsRaw", entry.second.isRaw);
+
+            if (entry.second.isRaw) {
+                const ShotInfo& info = entry.second.info;
+                keyFile.set_string(group, "Make", info.make);
+                keyFile.set_string(group, "Model", info.model);
+                keyFile.set_string(group, "Lens", info.lens);
+                keyFile.set_integer(group, "ISO", info.iso);
+                keyFile.set_double(group, "Shutter", info.shutter);
+                keyFile.set_double(group, "FocalLength", info.focalLength);
+                keyFile.set_double(group, "FNumber", info.fnumber);
+                keyFile.set_int64(group, "Timestamp", info.timestamp);
+                keyFile.set_int64(group, "RawTimestamp", info.rawTimestamp);
+            }
+        }
+
+        keyFile.save_to_file(fname);
+        dirty = false;
+    } catch (const Glib::Error& e) {
+        if (settings->verbose) {
+            printf("Error saving %s: %s\n", fname.c_str(), e.what().c_str());
+        }
+    }
+}
+
+const RawFileIndex::ShotInfo* RawFileIndex::get(const Glib::ustring& filename)
+{
+    GStatBuf st;
+
+    if (g_stat(filename.c_str(), &st) != 0) {
+        return nullptr;
+    }
+
+    const auto iter = entries.find(filename);
+
+    if (iter != entries.end() && iter->second.mtime == st.st_mtime && iter->second.size == st.st_size) {
+        iter->second.seen = true;
+        return iter->second.isRaw ? &iter->second.info : nullptr;
+    }
+
+    Entry entry = {st.st_mtime, st.st_size, false, true, {}};
+
+    RawImage ri(filename);
+
+    if (ri.loadRaw(false) == 0) { // Read information about shot
+        const FramesData idata(filename, std::unique_ptr<RawMetaDataLocation>(new RawMetaDataLocation(ri.get_exifBase(), ri.get_ciffBase(), ri.get_ciffLen())), true);
+        entry.isRaw = true;
+        entry.info.make = idata.getMake();
+        entry.info.model = idata.getModel();
+        entry.info.lens = idata.getLens();
+        entry.info.iso = idata.getISOSpeed();
+        entry.info.shutter = idata.getShutterSpeed();
+        entry.info.focalLength = idata.getFocalLen();
+        entry.info.fnumber = idata.getFNumber();
+        entry.info.timestamp = idata.getDateTimeAsTS();
+        entry.info.rawTimestamp = ri.get_timestamp();
+    }
+
+    dirty = true;
+    Entry& stored = entries[filename] = entry;
+    return stored.isRaw ? &stored.info : nullptr;
+}
+
+}
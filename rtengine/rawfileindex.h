@@ -0,0 +1,80 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <string>
+
+#include <glib.h>
+#include <glibmm/ustring.h>
+
+#include "noncopyable.h"
+
+namespace rtengine
+{
+
+/**
+ * Index of the shot information of the files of a folder of dark frames or flat fields.
+ *
+ * The index is kept in the cache folder, so that the raw files don't have to be opened
+ * again at startup as long as their modification time and size don't change.
+ */
+class RawFileIndex final :
+    public NonCopyable
+{
+public:
+    struct ShotInfo {
+        std::string make;
+        std::string model;
+        std::string lens;
+        int iso;
+        double shutter;
+        double focalLength;
+        double fnumber;
+        time_t timestamp;    ///< date of the shot, from the metadata
+        time_t rawTimestamp; ///< date of the shot, as read by the raw decoder
+    };
+
+    /** @param indexName name of the index file in the cache folder */
+    explicit RawFileIndex(const Glib::ustring& indexName);
+
+    /** Loads the index, discarding it if it was saved for another folder */
+    void load(const Glib::ustring& folder);
+    /** Saves the index if it changed, forgetting the files that have not been requested since load() */
+    void save();
+
+    /** @return the shot information of a file, reading the file if it isn't indexed or has changed;
+      *         nullptr if the file isn't a raw file */
+    const ShotInfo* get(const Glib::ustring& filename);
+
+private:
+    struct Entry {
+        gint64 mtime;
+        gint64 size;
+        bool isRaw;
+        bool seen;
+        ShotInfo info;
+    };
+
+    const Glib::ustring indexName;
+    Glib::ustring folder;
+    std::map<Glib::ustring, Entry> entries;
+    bool dirty;
+};
+
+}
@@ -27,6 +27,7 @@ RawImage::RawImage(const Glib::ustring &name)
     , rotate_deg(0)
     , profile_data(nullptr)
     , allocation(nullptr)
+    , closeAfterCompress(false)
 {
     memset(maximum_c4, 0, sizeof(maximum_c4));
     RT_matrix_from_constant = ThreeValBool::X;
@@ -36,6 +37,14 @@ RawImage::RawImage(const Glib::ustring &name)
 
 RawImage::~RawImage()
 {
+    if (float_raw_image) {
+        if (!RT_is_mapped(float_raw_image)) {
+            delete [] float_raw_image;
+        }
+
+        float_raw_image = nullptr;
+    }
+
     if (ifp) {
         fclose(ifp);
         ifp = nullptr;
@@ -50,11 +59,6 @@ RawImage::~RawImage()
         allocation = nullptr;
     }
 
-    if (float_raw_image) {
-        delete [] float_raw_image;
-        float_raw_image = nullptr;
-    }
-
     if (data) {
         delete [] data;
         data = nullptr;
@@ -598,8 +602,16 @@ int RawImage::loadRaw(bool loadData, unsigned int imageNum, bool closeFile, Prog
             }
 
             crop_masked_pixels();
-            free(raw_image);
-            raw_image = nullptr;
+
+            if (!RT_is_mapped(raw_image)) {
+                free(raw_image);
+                raw_image = nullptr;
+            } else if (data_error) {
+                raw_image = nullptr; // image stays empty, like when the samples are loaded in memory
+            }
+
+            // else the samples are read in place from the file by compress_image, or by get_image when image is needed,
+            // which avoids both the copy of the raw data and filling the full size image for the processing
         } else {
             if (get_maker() == "Sigma" && cc && cc->has_rawCrop(width, height)) { // foveon images
                 raw_crop_cc = true;
@@ -711,8 +723,12 @@ int RawImage::loadRaw(bool loadData, unsigned int imageNum, bool closeFile, Prog
     }
 
     if (closeFile) {
-        fclose(ifp);
-        ifp = nullptr;
+        if (raw_image || RT_is_mapped(float_raw_image)) {
+            closeAfterCompress = true;
+        } else {
+            fclose(ifp);
+            ifp = nullptr;
+        }
     }
 
     if (plistener) {
@@ -722,6 +738,28 @@ int RawImage::loadRaw(bool loadData, unsigned int imageNum, bool closeFile, Prog
     return 0;
 }
 
+DCraw::dcrawImage_t RawImage::get_image()
+{
+    if (image && raw_image) {
+        // fill image from the samples still in the file, like crop_masked_pixels does when they're loaded in memory
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+
+        for (int row = 0; row < height; row++) {
+            const ushort* const src = raw_image + (row + top_margin) * raw_width + left_margin;
+
+            for (int col = 0; col < width; col++) {
+                image[row * iwidth + col][fcol(row, col)] = src[col];
+            }
+        }
+
+        raw_image = nullptr;
+    }
+
+    return image;
+}
+
 float** RawImage::compress_image(unsigned int frameNum, bool freeImage)
 {
     if (!image) {
@@ -770,8 +808,24 @@ float** RawImage::compress_image(unsigned int frameNum, bool freeImage)
                 this->data[row][col] = float_raw_image[(row + top_margin) * raw_width + col + left_margin];
             }
 
-        delete [] float_raw_image;
+        if (!RT_is_mapped(float_raw_image)) {
+            delete [] float_raw_image;
+        }
+
         float_raw_image = nullptr;
+    } else if (raw_image) {
+        // Bayer or X-Trans samples still in the file, image hasn't been filled
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+
+        for (int row = 0; row < height; row++) {
+            const ushort* const src = raw_image + (row + top_margin) * raw_width + left_margin;
+
+            for (int col = 0; col < width; col++) {
+                this->data[row][col] = src[col];
+            }
+        }
     } else if (filters != 0 && !isXtrans()) {
 #ifdef _OPENMP
         #pragma omp parallel for
@@ -819,6 +873,13 @@ float** RawImage::compress_image(unsigned int frameNum, bool freeImage)
     if (freeImage) {
         free(image); // we don't need this anymore
         image = nullptr;
+        raw_image = nullptr;
+
+        if (closeAfterCompress) {
+            fclose(ifp);
+            ifp = nullptr;
+            closeAfterCompress = false;
+        }
     }
 
     return data;
@@ -45,10 +45,7 @@ public:
             filters &= ~((filters & 0x55555555) << 1);
         }
     }
-    dcrawImage_t get_image()
-    {
-        return image;
-    }
+    dcrawImage_t get_image();
     float** compress_image(unsigned int frameNum, bool freeImage = true); // revert to compressed pixels format and release image data
     float** data;             // holds pixel values, data[i][j] corresponds to the ith row and jth column
     unsigned prefilters;               // original filters saved ( used for 4 color processing )
@@ -61,6 +58,7 @@ protected:
     int rotate_deg; // 0,90,180,270 degree of rotation: info taken by dcraw from exif
     char* profile_data; // Embedded ICC color profile
     float* allocation; // pointer to allocated memory
+    bool closeAfterCompress; // the file is kept open while the raw data is read in place from it
     int maximum_c4[4];
     bool isFoveon() const
     {
@@ -114,6 +112,12 @@ public:
         return float_raw_image;
     }
 
+    // Samples read in place from the memory mapped file, until image is filled. nullptr if they have been copied to image
+    ushort const * get_RawImage() const
+    {
+        return raw_image;
+    }
+
     eSensorType getSensorType() const;
 
     void getRgbCam(float rgbcam[3][4]);
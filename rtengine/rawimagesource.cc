@@ -1436,7 +1436,17 @@ void RawImageSource::preprocess  (const RAWParams &raw, const LensProfParams &le
         printf("Flat Field Correction:%s\n", rif->get_filename().c_str());
     }
 
-    if (numFrames == 4) {
+    // Without flat field nor gain map, the pixels are copied, dark frame subtracted and scaled in one pass
+    const bool scaleOnCopy =
+        (ri->getSensorType() == ST_BAYER || ri->getSensorType() == ST_FUJI_XTRANS)
+        && numFrames != 4
+        && !(numFrames == 2 && currFrame == 2)
+        && !hasFlatField
+        && !(raw.ff_FromMetaData && isGainMapSupported());
+
+    if (scaleOnCopy) {
+        copyAndScaleOriginalPixels(raw, rid, rawData);
+    } else if (numFrames == 4) {
         int bufferNumber = 0;
         for (unsigned int i=0; i<4; ++i) {
             if (i==currFrame) {
@@ -1513,7 +1523,7 @@ void RawImageSource::preprocess  (const RAWParams &raw, const LensProfParams &le
         for (int i=0; i<4; ++i) {
             scaleColors(0, 0, W, H, raw, *rawDataFrames[i]);
         }
-    } else {
+    } else if (!scaleOnCopy) {
         scaleColors(0, 0, W, H, raw, rawData); //+ + raw parameters for black level(raw.blackxx)
     }
 
@@ -1843,6 +1853,7 @@ void RawImageSource::retinexPrepareBuffers(const ColorManagementParams& cmp, con
 
     LUTf *retinexgamtab = nullptr;//gamma before and after Retinex to restore tones
     LUTf lutTonereti;
+    Color::initExtraGammas();
 
     if (retinexParams.gammaretinex == "low") {
         retinexgamtab = &(Color::gammatab_115_2);
@@ -2113,6 +2124,7 @@ void RawImageSource::retinex(const ColorManagementParams& cmp, const RetinexPara
     lutToneireti(65536);
 
     LUTf *retinexigamtab = nullptr;//gamma before and after Retinex to restore tones
+    Color::initExtraGammas();
 
     if (deh.gammaretinex == "low") {
         retinexigamtab = &(Color::igammatab_115_2);
@@ -2640,7 +2652,7 @@ void RawImageSource::copyOriginalPixels(const RAWParams &raw, RawImage *src, con
 }
 
 // Scale original pixels into the range 0 65535 using black offsets and multipliers
-void RawImageSource::scaleColors(int winx, int winy, int winw, int winh, const RAWParams &raw, array2D<float> &rawData)
+void RawImageSource::initScaleColors(const RAWParams &raw)
 {
     chmax[0] = chmax[1] = chmax[2] = chmax[3] = 0; //channel maxima
     float black_lev[4] = {0.f};//black level
@@ -2680,6 +2692,11 @@ void RawImageSource::scaleColors(int winx, int winy, int winw, int winh, const R
     for (int i = 0; i < 4 ; i++) {
         clmax[i] = (c_white[i] - cblacksom[i]) * scale_mul[i];    // raw clip level
     }
+}
+
+void RawImageSource::scaleColors(int winx, int winy, int winw, int winh, const RAWParams &raw, array2D<float> &rawData)
+{
+    initScaleColors(raw);
 
     // this seems strange, but it works
 
@@ -2808,6 +2825,108 @@ void RawImageSource::scaleColors(int winx, int winy, int winw, int winh, const R
 
 }
 
+void RawImageSource::copyAndScaleOriginalPixels(const RAWParams &raw, const RawImage *riDark, array2D<float> &rawData)
+{
+    const auto tmpfilters = ri->get_filters();
+    ri->set_filters(ri->prefilters); // we need 4 blacks for bayer processing
+    float black[4];
+    ri->get_colorsCoeff(nullptr, nullptr, black, false);
+    ri->set_filters(tmpfilters);
+
+    initScaleColors(raw);
+
+    if (!rawData) {
+        rawData(W, H);
+    }
+
+    const bool subtractDark = riDark && W == riDark->get_width() && H == riDark->get_height();
+    const bool xtrans = ri->getSensorType() == ST_FUJI_XTRANS;
+    constexpr int PERIOD = 12; // multiple of the Bayer and X-Trans patterns and of the vector size
+
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        float tmpchmax[3] = {0.f, 0.f, 0.f};
+
+#ifdef _OPENMP
+        #pragma omp for nowait
+#endif
+
+        for (int row = 0; row < H; row++) {
+            // coefficients of the pixels of the row, repeated every PERIOD columns
+            int color[PERIOD];
+            float darkBlack[PERIOD]; // added back after the dark frame subtraction, like in copyOriginalPixels
+            float scaleBlack[PERIOD];
+            float mul[PERIOD];
+
+            for (int k = 0; k < PERIOD; ++k) {
+                const int c = xtrans ? ri->XTRANSFC(row, k) : FC(row, k);
+                const int c4 = (!xtrans && c == 1 && !(row & 1)) ? 3 : c;
+                color[k] = c;
+                darkBlack[k] = black[c4];
+                scaleBlack[k] = cblacksom[c4];
+                mul[k] = scale_mul[c4];
+            }
+
+            const float* const src = ri->data[row];
+            const float* const dark = subtractDark ? riDark->data[row] : nullptr;
+            float* const dst = rawData[row];
+            int col = 0;
+#ifdef __SSE2__
+            const vfloat zerov = ZEROV;
+            vfloat maxv[PERIOD / 4] = {zerov, zerov, zerov};
+
+            for (; col < W - 3; col += 4) {
+                const int k = col % PERIOD;
+                vfloat valv = LVFU(src[col]);
+
+                if (dark) {
+                    valv = vmaxf(valv + LVFU(darkBlack[k]) - LVFU(dark[col]), zerov);
+                }
+
+                valv = vmaxf(valv - LVFU(scaleBlack[k]), zerov) * LVFU(mul[k]);
+                STVFU(dst[col], valv);
+                maxv[k / 4] = vmaxf(maxv[k / 4], valv);
+            }
+
+            float slotmax[PERIOD];
+
+            for (int k = 0; k < PERIOD; k += 4) {
+                STVFU(slotmax[k], maxv[k / 4]);
+            }
+
+            for (int k = 0; k < PERIOD; ++k) {
+                tmpchmax[color[k]] = max(tmpchmax[color[k]], slotmax[k]);
+            }
+
+#endif
+
+            for (; col < W; col++) {
+                const int k = col % PERIOD;
+                float val = src[col];
+
+                if (dark) {
+                    val = max(val + darkBlack[k] - dark[col], 0.f);
+                }
+
+                val = max(0.f, val - scaleBlack[k]) * mul[k];
+                dst[col] = val;
+                tmpchmax[color[k]] = max(tmpchmax[color[k]], val);
+            }
+        }
+
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+            chmax[0] = max(tmpchmax[0], chmax[0]);
+            chmax[1] = max(tmpchmax[1], chmax[1]);
+            chmax[2] = max(tmpchmax[2], chmax[2]);
+        }
+    }
+}
+
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 int RawImageSource::defTransform (int tran)
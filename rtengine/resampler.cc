@@ -0,0 +1,287 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "resampler.h"
+
+#include "alignedbuffer.h"
+#include "opthelper.h"
+#include "rt_math.h"
+#include "sleef.h"
+
+#include "../rtgui/threadutils.h"
+
+namespace
+{
+
+using rtengine::ResamplingKernel;
+
+// Weights of the source pixels for each destination pixel, along one direction
+struct FilterBank {
+    int taps;                   // maximum number of source pixels per destination pixel
+    std::vector<int> start;     // first source pixel of each destination pixel
+    std::vector<int> count;     // number of source pixels of each destination pixel
+    std::vector<float> weights; // taps weights per destination pixel
+};
+
+struct FilterBankKey {
+    int srcSize;
+    int dstSize;
+    float scale;
+    ResamplingKernel kernel;
+
+    bool operator ==(const FilterBankKey& other) const
+    {
+        return srcSize == other.srcSize && dstSize == other.dstSize && scale == other.scale && kernel == other.kernel;
+    }
+};
+
+float kernelRadius(ResamplingKernel kernel)
+{
+    switch (kernel) {
+        case ResamplingKernel::LANCZOS2:
+        case ResamplingKernel::MITCHELL:
+            return 2.f;
+
+        case ResamplingKernel::LANCZOS4:
+            return 4.f;
+
+        case ResamplingKernel::AREA:
+            return 0.5f;
+
+        case ResamplingKernel::LANCZOS3:
+        default:
+            return 3.f;
+    }
+}
+
+inline float lanczos(float x, float a)
+{
+    if (x * x < 1e-6f) {
+        return 1.0f;
+    } else if (x * x > a * a) {
+        return 0.0f;
+    } else {
+        x = static_cast<float>(rtengine::RT_PI) * x;
+        return a * xsinf(x) * xsinf(x / a) / (x * x);
+    }
+}
+
+inline float mitchell(float x)
+{
+    constexpr float B = 1.f / 3.f;
+    constexpr float C = 1.f / 3.f;
+    x = std::fabs(x);
+
+    if (x < 1.f) {
+        return ((12.f - 9.f * B - 6.f * C) * x * x * x + (-18.f + 12.f * B + 6.f * C) * x * x + (6.f - 2.f * B)) / 6.f;
+    } else if (x < 2.f) {
+        return ((-B - 6.f * C) * x * x * x + (6.f * B + 30.f * C) * x * x + (-12.f * B - 48.f * C) * x + (8.f * B + 24.f * C)) / 6.f;
+    } else {
+        return 0.f;
+    }
+}
+
+float kernelWeight(ResamplingKernel kernel, float x)
+{
+    switch (kernel) {
+        case ResamplingKernel::LANCZOS2:
+            return lanczos(x, 2.f);
+
+        case ResamplingKernel::LANCZOS4:
+            return lanczos(x, 4.f);
+
+        case ResamplingKernel::MITCHELL:
+            return mitchell(x);
+
+        case ResamplingKernel::AREA:
+            x = std::fabs(x);
+            return x < 0.5f ? 1.f : x == 0.5f ? 0.5f : 0.f;
+
+        case ResamplingKernel::LANCZOS3:
+        default:
+            return lanczos(x, 3.f);
+    }
+}
+
+FilterBank* buildFilterBank(const FilterBankKey& key)
+{
+    const float delta = 1.f / key.scale;
+    const float sc = rtengine::min(key.scale, 1.f);
+    const float radius = kernelRadius(key.kernel) / sc;
+
+    FilterBank* const bank = new FilterBank;
+    bank->taps = static_cast<int>(2.f * radius) + 2;
+    bank->start.resize(key.dstSize);
+    bank->count.resize(key.dstSize);
+    bank->weights.assign(static_cast<size_t>(key.dstSize) * bank->taps, 0.f);
+
+    for (int i = 0; i < key.dstSize; ++i) {
+        // coordinate of the center of the destination pixel in the source
+        const float x0 = (static_cast<float>(i) + 0.5f) * delta - 0.5f;
+        const int i0 = rtengine::max(0, static_cast<int>(std::floor(x0 - radius)) + 1);
+        const int i1 = rtengine::LIM(static_cast<int>(std::floor(x0 + radius)) + 1, i0 + 1, key.srcSize);
+        const int n = rtengine::min(i1 - i0, bank->taps);
+        float* const w = &bank->weights[static_cast<size_t>(i) * bank->taps];
+        float ws = 0.f;
+
+        for (int k = 0; k < n; ++k) {
+            w[k] = kernelWeight(key.kernel, sc * (x0 - static_cast<float>(i0 + k)));
+            ws += w[k];
+        }
+
+        if (ws != 0.f) {
+            for (int k = 0; k < n; ++k) {
+                w[k] /= ws;
+            }
+        } else {
+            w[0] = 1.f;
+        }
+
+        bank->start[i] = rtengine::min(i0, key.srcSize - 1);
+        bank->count[i] = n;
+    }
+
+    return bank;
+}
+
+std::shared_ptr<const FilterBank> getFilterBank(int srcSize, int dstSize, float scale, ResamplingKernel kernel)
+{
+    constexpr std::size_t MAX_ENTRIES = 8;
+    static MyMutex mutex;
+    static std::vector<std::pair<FilterBankKey, std::shared_ptr<const FilterBank>>> entries; // most recently used first
+
+    const FilterBankKey key = {srcSize, dstSize, scale, kernel};
+
+    MyMutex::MyLock lock(mutex);
+
+    for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+        if (iter->first == key) {
+            std::rotate(entries.begin(), iter, iter + 1);
+            return entries.front().second;
+        }
+    }
+
+    if (entries.size() == MAX_ENTRIES) {
+        entries.pop_back();
+    }
+
+    entries.emplace(entries.begin(), key, std::shared_ptr<const FilterBank>(buildFilterBank(key)));
+    return entries.front().second;
+}
+
+}
+
+namespace rtengine
+{
+
+void resample(
+    const float* const* const* src,
+    int srcW,
+    int srcH,
+    float* const* const* dst,
+    int dstW,
+    int dstH,
+    int channels,
+    float scale,
+    ResamplingKernel kernel,
+    bool multiThread
+)
+{
+    const std::shared_ptr<const FilterBank> hBank = getFilterBank(srcW, dstW, scale, kernel);
+    const std::shared_ptr<const FilterBank> vBank = getFilterBank(srcH, dstH, scale, kernel);
+
+#ifdef _OPENMP
+    #pragma omp parallel if (multiThread)
+#endif
+    {
+        // vertically interpolated row of one channel
+        AlignedBuffer<float> lineBuffer(srcW);
+        float* const line = lineBuffer.data;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+
+        for (int i = 0; i < dstH; ++i) {
+            const int i0 = vBank->start[i];
+            const int n = vBank->count[i];
+            const float* const wv = &vBank->weights[static_cast<size_t>(i) * vBank->taps];
+
+            for (int c = 0; c < channels; ++c) {
+                const float* const* const s = src[c];
+
+                // vertical pass, vectorized over the columns
+                int j = 0;
+#ifdef __SSE2__
+
+                for (; j < srcW - 3; j += 4) {
+                    vfloat v = ZEROV;
+
+                    for (int k = 0; k < n; ++k) {
+                        v += F2V(wv[k]) * LVFU(s[i0 + k][j]);
+                    }
+
+                    STVF(line[j], v);
+                }
+
+#endif
+
+                for (; j < srcW; ++j) {
+                    float v = 0.f;
+
+                    for (int k = 0; k < n; ++k) {
+                        v += wv[k] * s[i0 + k][j];
+                    }
+
+                    line[j] = v;
+                }
+
+                // horizontal pass, vectorized over the taps
+                float* const d = dst[c][i];
+
+                for (int x = 0; x < dstW; ++x) {
+                    const float* const l = line + hBank->start[x];
+                    const int m = hBank->count[x];
+                    const float* const wh = &hBank->weights[static_cast<size_t>(x) * hBank->taps];
+                    int k = 0;
+                    float v = 0.f;
+#ifdef __SSE2__
+                    vfloat vv = ZEROV;
+
+                    for (; k < m - 3; k += 4) {
+                        vv += LVFU(wh[k]) * LVFU(l[k]);
+                    }
+
+                    v = vhadd(vv);
+#endif
+
+                    for (; k < m; ++k) {
+                        v += wh[k] * l[k];
+                    }
+
+                    d[x] = v;
+                }
+            }
+        }
+    }
+}
+
+}
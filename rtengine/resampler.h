@@ -0,0 +1,54 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+namespace rtengine
+{
+
+enum class ResamplingKernel {
+    LANCZOS2,
+    LANCZOS3,
+    LANCZOS4,
+    MITCHELL,   // Mitchell-Netravali, B = C = 1/3
+    AREA        // box filter, averages the source pixels covered by each destination pixel when downscaling
+};
+
+/**
+ * Separable resampling of planar float channels: a vertical pass into a line buffer, followed by a horizontal pass.
+ *
+ * The normalized filter weights of each destination row and column only depend on the sizes, the scale
+ * and the kernel, and are cached, so that resizing several images to the same size doesn't compute them again.
+ *
+ * @param src rows of each source channel, srcW x srcH
+ * @param dst rows of each destination channel, dstW x dstH
+ * @param channels number of channels of src and dst
+ * @param scale ratio of the destination size to the source size
+ */
+void resample(
+    const float* const* const* src,
+    int srcW,
+    int srcH,
+    float* const* const* dst,
+    int dstW,
+    int dstH,
+    int channels,
+    float scale,
+    ResamplingKernel kernel,
+    bool multiThread = true
+);
+
+}
@@ -22,6 +22,7 @@
 #include <ctime>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include <glibmm/ustring.h>
 
@@ -82,6 +83,7 @@ class IImage16;
 class IImagefloat;
 class ImageSource;
 class TweakOperator;
+struct OutputSpec;
 
 /**
   * This class provides functions to obtain exif and IPTC metadata information
@@ -271,17 +273,17 @@ public:
 
 /** When the detailed crop image is ready for display during staged processing (thus the changes have been updated),
   * the staged processor notifies the listener class implementing a DetailedCropListener.
-  * It is important to note that the file passed to the listener can <b>not</b> be used in a shared manner, the class
-  * implementing this interface has to store a copy of it. */
+  * The images are handed over to the listener, which can keep them for display without copying them. */
 class DetailedCropListener
 {
 public:
     virtual ~DetailedCropListener() = default;
     /** With this member function the staged processor notifies the listener that the detailed crop image has been updated.
-      * @param img is a pointer to the detailed crop image */
+      * @param img is the detailed crop image in the monitor color space
+      * @param imgtrue is the detailed crop image in the output color space, for analysis */
     virtual void setDetailedCrop(
-        IImage8* img,
-        IImage8* imgtrue,
+        std::unique_ptr<IImage8> img,
+        std::unique_ptr<IImage8> imgtrue,
         const procparams::ColorManagementParams& cmp,
         const procparams::CropParams& cp,
         int cx,
@@ -686,7 +688,8 @@ public:
   * @param s is a struct of basic settings
   * @param baseDir base directory of RT's installation dir
   * @param userSettingsDir RT's base directory in the user's settings dir
-  * @param loadAll if false, don't load the various dependencies (profiles, HALDClut files, ...), they'll be loaded from disk each time they'll be used (launching time improvement) */
+  * @param loadAll if false, don't load the various dependencies (profiles, HALDClut files, ...), they'll be loaded from disk each time they'll be used,
+  *        and the lensfun database, camera constants, dark frames and flat fields are only read when first needed (launching time improvement) */
 int init (const Settings* s, const Glib::ustring& baseDir, const Glib::ustring& userSettingsDir, bool loadAll = true);
 
 /** Cleanup the RT engine (static variables) */
@@ -722,6 +725,11 @@ public:
     static void destroy (ProcessingJob* job);
 
     virtual bool fastPipeline() const = 0;
+
+    /** Adds outputs rendered from the same processing as the main one, by processImageOutputs() or by the batch processing.
+      * Only the crop, resize, sharpening and output profile stages are run once for each output.
+      * @param outputs the specifications of the additional outputs */
+    virtual void setExtraOutputs (const std::vector<OutputSpec>& outputs) = 0;
 };
 
 /** This function performs all the image processing steps corresponding to the given ProcessingJob. It returns when it is ready, so it can be slow.
@@ -732,6 +740,10 @@ public:
    * @return the resulting image, with the output profile applied, exif and iptc data set. You have to save it or you can access the pixel data directly.  */
 IImagefloat* processImage (ProcessingJob* job, int& errorCode, ProgressListener* pl = nullptr, bool flush = false);
 
+/** Same as processImage(), but also renders the extra outputs of the job, see ProcessingJob::setExtraOutputs().
+   * @return the main output followed by the extra outputs, in order, or an empty vector if an error occurred */
+std::vector<IImagefloat*> processImageOutputs (ProcessingJob* job, int& errorCode, ProgressListener* pl = nullptr, bool flush = false);
+
 /** This class is used to control the batch processing. The class implementing this interface will be called when the full processing of an
    * image is ready and the next job to process is needed. */
 class BatchProcessingListener : public ProgressListener
@@ -742,6 +754,11 @@ public:
                    * @param img is the result of the last ProcessingJob
                    * @return the next ProcessingJob to process */
     virtual ProcessingJob* imageReady(IImagefloat* img) = 0;
+
+    /** Same as imageReady(), for the jobs having extra outputs.
+                   * @param imgs are the main output and the extra outputs of the last ProcessingJob
+                   * @return the next ProcessingJob to process */
+    virtual ProcessingJob* imagesReady(const std::vector<IImagefloat*>& imgs) = 0;
 };
 /** This function performs all the image processing steps corresponding to the given ProcessingJob. It runs in the background, thus it returns immediately,
    * When it finishes, it calls the BatchProcessingListener with the resulting image and asks for the next job. It the listener gives a new job, it goes on
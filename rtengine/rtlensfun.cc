@@ -314,6 +314,7 @@ bool LFLens::hasCACorrection() const
 //-----------------------------------------------------------------------------
 
 LFDatabase LFDatabase::instance_;
+DeferredInit LFDatabase::deferredInit_;
 
 
 bool LFDatabase::init(const Glib::ustring &dbdir)
@@ -397,8 +398,15 @@ LFDatabase::~LFDatabase()
 }
 
 
+void LFDatabase::initDeferred(std::function<void()> loader)
+{
+    deferredInit_.set(std::move(loader));
+}
+
+
 const LFDatabase *LFDatabase::getInstance()
 {
+    deferredInit_.run();
     return &instance_;
 }
 
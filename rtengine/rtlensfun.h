@@ -28,6 +28,7 @@
 
 #include <lensfun.h>
 
+#include "deferredinit.h"
 #include "lcp.h"
 #include "noncopyable.h"
 
@@ -114,6 +115,8 @@ class LFDatabase final :
 {
 public:
     static bool init(const Glib::ustring &dbdir);
+    /** Registers a function loading the database, which is called by the first getInstance() */
+    static void initDeferred(std::function<void()> loader);
     static const LFDatabase *getInstance();
 
     ~LFDatabase();
@@ -140,6 +143,7 @@ private:
 
     mutable MyMutex lfDBMutex;
     static LFDatabase instance_;
+    static DeferredInit deferredInit_;
     lfDatabase *data_;
     mutable std::set<std::string> notFound;
 };
@@ -16,7 +16,9 @@
  *  You should have received a copy of the GNU General Public License
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <clocale>
+#include <vector>
 
 #include <lcms2.h>
 
@@ -38,12 +40,14 @@
 #include "jpeg.h"
 #include "labimage.h"
 #include "median.h"
+#include "opthelper.h"
 #include "procparams.h"
 #include "rawimage.h"
 #include "rawimagesource.h"
 #include "rtengine.h"
 #include "rtthumbnail.h"
 #include "settings.h"
+#include "sleef.h"
 #include "stdimagesource.h"
 #include "StopWatch.h"
 #include "utils.h"
@@ -187,6 +191,153 @@ void scale_colors (rtengine::RawImage *ri, float scale_mul[4], float cblack[4],
     }
 }
 
+// Statistics of the raw data for the auto exposure and the auto white balance of the thumbnail
+struct RawStats {
+    LUTu& histogram;
+    double camWb[3];
+    double clipval;
+    double pixSum[3];
+    unsigned int n[3];
+};
+
+/*
+ * Demosaics a Bayer or X-Trans raw image into dst by averaging the samples of each color in blocks of hskip x vskip
+ * sensor pixels (at least 2x2 for Bayer and 6x6 for X-Trans, so that each block holds all the colors).
+ * The samples are scaled like in scale_colors on the fly, so that the raw data is read once and never written.
+ * If stats isn't null, the histogram and the sums for the auto white balance are gathered in the same pass, single threaded.
+ */
+void bin_raw (rtengine::RawImage *ri, const float scale_mul[4], const float cblack[4], int hskip, int vskip, rtengine::Imagefloat* dst, RawStats* stats, bool multiThread)
+{
+    const unsigned short * const raw_image = ri->get_RawImage(); // samples read in place from the file, image isn't filled then
+    DCraw::dcrawImage_t image = raw_image ? nullptr : ri->get_image();
+    const int height = ri->get_iheight();
+    const int width = ri->get_iwidth();
+    const int top_margin = ri->get_topmargin();
+    const int left_margin = ri->get_leftmargin();
+    const int raw_width = ri->get_rawwidth();
+    const bool isFloat = ri->isFloat();
+    const float * const float_raw_image = ri->get_FloatRawImage();
+    const bool xtrans = ri->isXtrans();
+
+    const int period = xtrans ? 6 : 2;
+    const int bw = std::max(hskip, period);
+    const int bh = std::max(vskip, period);
+    const int dstW = dst->getWidth();
+    const int dstH = dst->getHeight();
+    const int lineWidth = std::min(width, (dstW - 1) * hskip + bw);
+
+#ifdef _OPENMP
+    #pragma omp parallel if(multiThread && !stats)
+#endif
+    {
+        std::vector<float> line(lineWidth);
+        std::vector<float> sums(dstW * 3);
+        std::vector<int> counts(dstW * 3);
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 4)
+#endif
+
+        for (int y = 0; y < dstH; ++y) {
+            std::fill(sums.begin(), sums.end(), 0.f);
+            std::fill(counts.begin(), counts.end(), 0);
+            const int row0 = y * vskip;
+            const int row1 = std::min(row0 + bh, height);
+
+            for (int row = row0; row < row1; ++row) {
+                unsigned cfa[6];  // channel of the samples in the raw data
+                int color[6];     // color of the samples, the second green of Bayer being green
+                float black[6];
+                float mul[6];
+
+                for (int i = 0; i < period; ++i) {
+                    cfa[i] = xtrans ? ri->XTRANSFC (row, i) : ri->FC (row, i);
+                    color[i] = cfa[i] == 3 ? 1 : cfa[i];
+                    black[i] = cblack[cfa[i]];
+                    mul[i] = scale_mul[cfa[i]];
+                }
+
+                if (isFloat) {
+                    const float* const src = float_raw_image + (row + top_margin) * raw_width + left_margin;
+                    int col = 0;
+#ifdef __SSE2__
+
+                    if (!xtrans) {
+                        const vfloat blackv = _mm_setr_ps(black[0], black[1], black[0], black[1]);
+                        const vfloat mulv = _mm_setr_ps(mul[0], mul[1], mul[0], mul[1]);
+                        const vfloat zerov = ZEROV;
+                        const vfloat maxv = F2V(65535.f);
+
+                        for (; col < lineWidth - 3; col += 4) {
+                            STVFU(line[col], vminf(vmaxf((LVFU(src[col]) - blackv) * mulv, zerov), maxv));
+                        }
+                    }
+
+#endif
+
+                    for (int i = col % period; col < lineWidth; ++col) {
+                        line[col] = rtengine::CLIP ((src[col] - black[i]) * mul[i]);
+                        i = i + 1 == period ? 0 : i + 1;
+                    }
+                } else if (raw_image) {
+                    const unsigned short * const src = raw_image + (row + top_margin) * raw_width + left_margin;
+
+                    for (int col = 0, i = 0; col < lineWidth; ++col) {
+                        line[col] = rtengine::CLIP ((src[col] - black[i]) * mul[i]);
+                        i = i + 1 == period ? 0 : i + 1;
+                    }
+                } else {
+                    const unsigned short (* const src)[4] = image + row * width;
+
+                    for (int col = 0, i = 0; col < lineWidth; ++col) {
+                        line[col] = rtengine::CLIP ((src[col][cfa[i]] - black[i]) * mul[i]);
+                        i = i + 1 == period ? 0 : i + 1;
+                    }
+                }
+
+                for (int x = 0; x < dstW; ++x) {
+                    const int col0 = x * hskip;
+                    const int col1 = std::min(col0 + bw, lineWidth);
+                    float* const sum = &sums[x * 3];
+                    int* const count = &counts[x * 3];
+
+                    for (int col = col0, i = col0 % period; col < col1; ++col) {
+                        sum[color[i]] += line[col];
+                        ++count[color[i]];
+                        i = i + 1 == period ? 0 : i + 1;
+                    }
+                }
+
+                // blocks overlap when they're smaller than the pattern, count each row once
+                if (stats && row >= 32 && row < height - 32 && row < row0 + vskip) {
+                    const int end = std::min(width - 32, lineWidth);
+
+                    for (int col = 32, i = 32 % period; col < end; ++col) {
+                        const int c = color[i];
+                        const double v = line[col];
+                        stats->histogram[(int)(stats->camWb[c] * v)]++;
+
+                        if (v <= stats->clipval) {
+                            stats->pixSum[c] += v;
+                            stats->n[c]++;
+                        }
+
+                        i = i + 1 == period ? 0 : i + 1;
+                    }
+                }
+            }
+
+            for (int x = 0; x < dstW; ++x) {
+                const float* const sum = &sums[x * 3];
+                const int* const count = &counts[x * 3];
+                dst->r (y, x) = count[0] ? sum[0] / count[0] : 0.f;
+                dst->g (y, x) = count[1] ? sum[1] / count[1] : 0.f;
+                dst->b (y, x) = count[2] ? sum[2] / count[2] : 0.f;
+            }
+        }
+    }
+}
+
 }
 
 namespace rtengine
@@ -589,9 +740,14 @@ Thumbnail* Thumbnail::loadFromRaw (const Glib::ustring& fname, RawMetaDataLocati
 
     float pre_mul[4], scale_mul[4], cblack[4];
     ri->get_colorsCoeff (pre_mul, scale_mul, cblack, false);
-    scale_colors (ri, scale_mul, cblack, forHistogramMatching); // enable multithreading when forHistogramMatching is true
 
-    ri->pre_interpolate();
+    // Bayer and X-Trans images are binned straight from the raw data, see bin_raw
+    const bool binned = (ri->isBayer() || ri->isXtrans()) && ri->get_colors() == 3 && ri->get_FujiWidth() == 0;
+
+    if (!binned) {
+        scale_colors (ri, scale_mul, cblack, forHistogramMatching); // enable multithreading when forHistogramMatching is true
+        ri->pre_interpolate();
+    }
 
     rml.exifBase = ri->get_exifBase();
     rml.ciffBase = ri->get_ciffBase();
@@ -651,11 +807,33 @@ Thumbnail* Thumbnail::loadFromRaw (const Glib::ustring& fname, RawMetaDataLocati
     int tmpw = (width - 2) / hskip;
     int tmph = (height - 2) / vskip;
 
-    DCraw::dcrawImage_t image = ri->get_image();
+    DCraw::dcrawImage_t image = binned ? nullptr : ri->get_image();
 
     Imagefloat* tmpImg = new Imagefloat (tmpw, tmph);
 
-    if (ri->getSensorType() == ST_BAYER) {
+    double pixSum[3] = {0.0};
+    unsigned int n[3] = {0};
+
+    if (!forHistogramMatching) { // we don't need this for histogram matching
+        tpp->aeHistCompression = 3;
+        tpp->aeHistogram(65536 >> tpp->aeHistCompression);
+        tpp->aeHistogram.clear();
+    }
+
+    if (binned) {
+        if (forHistogramMatching) {
+            bin_raw (ri, scale_mul, cblack, hskip, vskip, tmpImg, nullptr, true);
+        } else {
+            const double compression = pow(2.0, tpp->aeHistCompression);
+            RawStats stats = {tpp->aeHistogram, {tpp->camwbRed / compression, tpp->camwbGreen / compression, tpp->camwbBlue / compression}, 64000.0 / tpp->defGain, {0.0}, {0}};
+            bin_raw (ri, scale_mul, cblack, hskip, vskip, tmpImg, &stats, false);
+
+            for (int c = 0; c < 3; ++c) {
+                pixSum[c] = stats.pixSum[c];
+                n[c] = stats.n[c];
+            }
+        }
+    } else if (ri->getSensorType() == ST_BAYER) {
         // demosaicing! (sort of)
         for (int row = 1, y = 0; row < height - 1 && y < tmph; row += vskip, y++) {
             rofs = row * width;
@@ -837,19 +1015,13 @@ Thumbnail* Thumbnail::loadFromRaw (const Glib::ustring& fname, RawMetaDataLocati
     if(!forHistogramMatching) { // we don't need this for histogram matching
 
         // generate histogram for auto exposure, also calculate autoWB
-        tpp->aeHistCompression = 3;
-        tpp->aeHistogram(65536 >> tpp->aeHistCompression);
-        tpp->aeHistogram.clear();
-
         const unsigned int add = filter ? 1 : 4 / ri->get_colors();
 
-        double pixSum[3] = {0.0};
-        unsigned int n[3] = {0};
         const double compression = pow(2.0, tpp->aeHistCompression);
         const double camWb[3] = {tpp->camwbRed / compression, tpp->camwbGreen / compression, tpp->camwbBlue / compression};
         const double clipval = 64000.0 / tpp->defGain;
 
-        for (int i = 32; i < height - 32; i++) {
+        for (int i = 32; !binned && i < height - 32; i++) { // gathered by bin_raw when binned
             int start, end;
 
             if (ri->get_FujiWidth() != 0) {
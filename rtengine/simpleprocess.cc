@@ -76,6 +76,7 @@ public:
         imgsrc(nullptr),
         fw(0),
         fh(0),
+        earlyScale(1.0),
         tr(0),
         pp(0, 0, 0, 0, 0),
         calclum(nullptr),
@@ -116,6 +117,11 @@ public:
         }
     }
 
+    std::vector<IImagefloat*> outputs()
+    {
+        return outputs_pipeline();
+    }
+
 private:
     Imagefloat *normal_pipeline()
     {
@@ -140,12 +146,50 @@ private:
             return nullptr;
         }
 
-        stage_transform();
-        stage_early_resize();
+        if (stage_early_downscale()) {
+            stage_transform();
+        } else {
+            stage_transform();
+            stage_early_resize();
+        }
+
         stage_denoise();
         return stage_finish();
     }
 
+    /**
+     * Renders the image once up to the Lab stage, then the main output and the extra outputs of the job from it.
+     * The fast export pipeline is not used, as its early resize depends on the output.
+     */
+    std::vector<IImagefloat*> outputs_pipeline()
+    {
+        std::vector<IImagefloat*> images;
+
+        if (!stage_init()) {
+            return images;
+        }
+
+        stage_denoise();
+        stage_transform();
+        stage_lab();
+
+        const std::vector<OutputSpec> extraOutputs = job->extraOutputs;
+        LabImage* const rendered = labView;
+
+        for (size_t i = 0; i <= extraOutputs.size(); ++i) {
+            if (i > 0) {
+                extraOutputs[i - 1].applyTo(job->pparams);
+            }
+
+            // the last output consumes the rendered image
+            labView = i < extraOutputs.size() ? new LabImage(*rendered, true) : rendered;
+            images.push_back(stage_output());
+        }
+
+        stage_release();
+        return images;
+    }
+
     bool stage_init()
     {
         errorCode = 0;
@@ -895,7 +939,13 @@ private:
 
         ipf.firstAnalysis(baseImg, params, hist16);
 
+        if (earlyScale != 1.0) {
+            // size of the dehaze patches as if the image had not been downscaled
+            ipf.setScale(1.0 / earlyScale);
+        }
+
         ipf.dehaze(baseImg, params.dehaze);
+        ipf.setScale(1.0);
         ipf.ToneMapFattal02(baseImg, params.fattal, 3, 0, nullptr, 0, 0, 0);
 
         // perform transform (excepted resizing)
@@ -919,6 +969,14 @@ private:
     }
 
     Imagefloat *stage_finish()
+    {
+        stage_lab();
+        Imagefloat* const readyImg = stage_output();
+        stage_release();
+        return readyImg;
+    }
+
+    void stage_lab()
     {
         procparams::ProcParams& params = job->pparams;
         //ImProcFunctions ipf (&params, true);
@@ -1733,6 +1791,16 @@ private:
         if (pl) {
             pl->setProgress(0.60);
         }
+    }
+
+    /**
+     * Crops, resizes and converts labView to the output profile, and deletes it.
+     * Only uses the parameters of OutputSpec, besides the crop, the black-and-white flags and the metadata.
+     */
+    Imagefloat *stage_output()
+    {
+        procparams::ProcParams& params = job->pparams;
+        ImProcFunctions &ipf = * (ipf_p.get());
 
         int imw, imh;
         double tmpScale = ipf.resizeScale(&params, fw, fh, imw, imh);
@@ -1879,6 +1947,11 @@ private:
 //    if( settings->verbose )
 //           printf("Total:- %d usec\n", t2.etime(t1));
 
+        return readyImg;
+    }
+
+    void stage_release()
+    {
         if (!job->initialImage) {
             initialImage->decreaseRef();
         }
@@ -1900,7 +1973,62 @@ private:
             hist16.reset();
             hist16C.reset();
         */
-        return readyImg;
+    }
+
+    /**
+     * Downscales the image right after demosaicing, so that the colour space conversion, the transformation,
+     * the denoise and all the following tools run at the output resolution.
+     * The crop is kept and expressed in the coordinates of the downscaled image.
+     * @return false if the image is not downscaled, in which case stage_early_resize() has to be used
+     */
+    bool stage_early_downscale()
+    {
+        procparams::ProcParams& params = job->pparams;
+        ImProcFunctions &ipf = * (ipf_p.get());
+
+        int imw, imh;
+        const double scale_factor = ipf.resizeScale(&params, fw, fh, imw, imh);
+
+        if (scale_factor >= 1.0) {
+            return false;
+        }
+
+        const int sw = std::max(static_cast<int>(fw * scale_factor + 0.5), 1);
+        const int sh = std::max(static_cast<int>(fh * scale_factor + 0.5), 1);
+
+        Imagefloat* const resized = new Imagefloat(sw, sh);
+        ipf.Lanczos(baseImg, resized, scale_factor);
+        delete baseImg;
+        baseImg = resized;
+
+        // Lanczos rings below 0 at high contrast edges, and these camera values still go
+        // through the film negative processing, which raises them to a power
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+
+        for (int i = 0; i < sh; ++i) {
+            for (int j = 0; j < sw; ++j) {
+                baseImg->r(i, j) = std::max(baseImg->r(i, j), 0.f);
+                baseImg->g(i, j) = std::max(baseImg->g(i, j), 0.f);
+                baseImg->b(i, j) = std::max(baseImg->b(i, j), 0.f);
+            }
+        }
+
+        if (params.crop.enabled) {
+            params.crop.w = std::min(imw, sw);
+            params.crop.h = std::min(imh, sh);
+            params.crop.x = LIM(static_cast<int>(params.crop.x * scale_factor + 0.5), 0, sw - params.crop.w);
+            params.crop.y = LIM(static_cast<int>(params.crop.y * scale_factor + 0.5), 0, sh - params.crop.h);
+        }
+
+        adjust_procparams(scale_factor);
+
+        earlyScale = scale_factor;
+        fw = sw;
+        fh = sh;
+
+        return true;
     }
 
     void stage_early_resize()
@@ -1943,6 +2071,7 @@ private:
             tmplab = std::move(resized);
         }
 
+        params.crop.enabled = false;
         adjust_procparams(scale_factor);
 
         fw = imw;
@@ -1959,7 +2088,6 @@ private:
         procparams::ProcParams defaultparams;
 
         params.resize.enabled = false;
-        params.crop.enabled = false;
 
         if (params.prsharpening.enabled) {
             params.sharpening = params.prsharpening;
@@ -2048,6 +2176,7 @@ private:
     ImageSource *imgsrc;
     int fw;
     int fh;
+    double earlyScale; // downscaling done by stage_early_downscale()
 
     int tr;
     PreviewProps pp;
@@ -2119,6 +2248,12 @@ IImagefloat* processImage(ProcessingJob* pjob, int& errorCode, ProgressListener*
     return proc();
 }
 
+std::vector<IImagefloat*> processImageOutputs(ProcessingJob* pjob, int& errorCode, ProgressListener* pl, bool flush)
+{
+    ImageProcessor proc(pjob, errorCode, pl, flush);
+    return proc.outputs();
+}
+
 void batchProcessingThread(ProcessingJob* job, BatchProcessingListener* bpl)
 {
 
@@ -2126,14 +2261,21 @@ void batchProcessingThread(ProcessingJob* job, BatchProcessingListener* bpl)
 
     while (currentJob) {
         int errorCode;
-        IImagefloat* img = processImage(currentJob, errorCode, bpl, true);
+        const bool multipleOutputs = !static_cast<ProcessingJobImpl*>(currentJob)->extraOutputs.empty();
+        std::vector<IImagefloat*> imgs;
+
+        if (multipleOutputs) {
+            imgs = processImageOutputs(currentJob, errorCode, bpl, true);
+        } else {
+            imgs.push_back(processImage(currentJob, errorCode, bpl, true));
+        }
 
         if (errorCode) {
             bpl->error(M("MAIN_MSG_CANNOTLOAD"));
             currentJob = nullptr;
         } else {
             try {
-                currentJob = bpl->imageReady(img);
+                currentJob = multipleOutputs ? bpl->imagesReady(imgs) : bpl->imageReady(imgs[0]);
             } catch (Glib::Exception& ex) {
                 bpl->error(ex.what());
                 currentJob = nullptr;
@@ -1157,6 +1157,10 @@ void ImProcFunctions::ToneMapFattal02(Imagefloat *rgb, const FattalToneMappingPa
         Median_Denoise(Yr, Yr, luminance_noise_floor, w, h, med, 1, num_threads, L);
     }
 
+    if (isCancelled()) {
+        return;
+    }
+
     float noise = alpha * 0.01f;
 
     if (settings->verbose) {
@@ -1168,6 +1172,10 @@ void ImProcFunctions::ToneMapFattal02(Imagefloat *rgb, const FattalToneMappingPa
 
     tmo_fattal02(w2, h2, L, L, alpha, beta, noise, detail_level, multiThread, 0);
 
+    if (isCancelled()) {
+        return;
+    }
+
     const float hr = float(h2) / float(h);
     const float wr = float(w2) / float(w);
 
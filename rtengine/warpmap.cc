@@ -0,0 +1,121 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "warpmap.h"
+
+namespace rtengine
+{
+
+WarpMap::WarpMap(int width, int height, int channels, const Mapping& mapping, double maxError, bool multiThread) :
+    channels(channels),
+    gridWidth((width - 1) / STEP + 2),
+    gridHeight((height - 1) / STEP + 2),
+    exactCells((gridWidth - 1) * (gridHeight - 1), false)
+{
+    for (int c = 0; c < channels; ++c) {
+        grid[c].resize(gridWidth * gridHeight * 2);
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 4) if (multiThread)
+#endif
+
+    for (int gy = 0; gy < gridHeight; ++gy) {
+        for (int gx = 0; gx < gridWidth; ++gx) {
+            for (int c = 0; c < channels; ++c) {
+                double* const p = &grid[c][(gy * gridWidth + gx) * 2];
+                mapping(gx * STEP, gy * STEP, c, p[0], p[1]);
+            }
+        }
+    }
+
+    // Checks the interpolation at the center and at the middle of the top and left edges of each cell
+    const int cellsWidth = gridWidth - 1;
+    const int cellsHeight = gridHeight - 1;
+    constexpr int half = STEP / 2;
+    constexpr int probes[3][2] = {{half, half}, {half, 0}, {0, half}};
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 4) if (multiThread)
+#endif
+
+    for (int gy = 0; gy < cellsHeight; ++gy) {
+        for (int gx = 0; gx < cellsWidth; ++gx) {
+            bool exact = false;
+
+            for (int c = 0; !exact && c < channels; ++c) {
+                for (const auto& probe : probes) {
+                    const int x = gx * STEP + probe[0];
+                    const int y = gy * STEP + probe[1];
+                    double mx, my, ix, iy;
+                    mapping(x, y, c, mx, my);
+                    interpolate(x, y, c, ix, iy);
+
+                    if (std::fabs(mx - ix) > maxError || std::fabs(my - iy) > maxError) {
+                        exact = true;
+                        break;
+                    }
+                }
+            }
+
+            exactCells[gy * cellsWidth + gx] = exact;
+        }
+    }
+}
+
+bool WarpMapCache::Key::operator ==(const Key& other) const
+{
+    return
+        cx == other.cx
+        && cy == other.cy
+        && width == other.width
+        && height == other.height
+        && oW == other.oW
+        && oH == other.oH
+        && channels == other.channels
+        && ascale == other.ascale
+        && metadata == other.metadata
+        && rawRotationDeg == other.rawRotationDeg
+        && coarse == other.coarse
+        && commonTrans == other.commonTrans
+        && rotate == other.rotate
+        && perspective == other.perspective
+        && lensProf == other.lensProf;
+}
+
+std::shared_ptr<const WarpMap> WarpMapCache::get(const Key& key, const std::function<WarpMap*()>& build)
+{
+    MyMutex::MyLock lock(mutex);
+
+    for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+        if (iter->first == key) {
+            std::rotate(entries.begin(), iter, iter + 1);
+            return entries.front().second;
+        }
+    }
+
+    if (entries.size() == MAX_ENTRIES) {
+        entries.pop_back();
+    }
+
+    entries.emplace(entries.begin(), key, std::shared_ptr<const WarpMap>(build()));
+    return entries.front().second;
+}
+
+}
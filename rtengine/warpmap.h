@@ -0,0 +1,136 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "noncopyable.h"
+#include "procparams.h"
+
+#include "../rtgui/threadutils.h"
+
+namespace rtengine
+{
+
+class FramesMetaData;
+
+/**
+ * Source coordinates of a geometric transformation, for each pixel of the transformed image.
+ *
+ * The mapping is evaluated on a grid of STEP pixels and bilinearly interpolated in between. The cells of
+ * the grid where the interpolation deviates from the mapping by more than the given error are flagged,
+ * and the mapping has to be evaluated for each of their pixels, so that strongly curved mappings
+ * (fisheye lenses, extreme perspective) keep their accuracy.
+ */
+class WarpMap final :
+    public NonCopyable
+{
+public:
+    /** Computes the source coordinates (mx, my) of the pixel (x, y) of the transformed image, for a channel */
+    using Mapping = std::function<void(double x, double y, int channel, double& mx, double& my)>;
+
+    static constexpr int STEP = 16;
+
+    /**
+     * @param width width of the transformed image
+     * @param height height of the transformed image
+     * @param channels 1 if the mapping is the same for the 3 channels, 3 otherwise
+     * @param maxError tolerated interpolation error, in pixels
+     */
+    WarpMap(int width, int height, int channels, const Mapping& mapping, double maxError, bool multiThread);
+
+    int getChannels() const
+    {
+        return channels;
+    }
+
+    /**
+     * Interpolates the source coordinates of the pixel (x, y)
+     * @return false if the pixel lies in a cell where the mapping has to be evaluated exactly
+     */
+    bool interpolate(int x, int y, int channel, double& mx, double& my) const
+    {
+        const int gx = x / STEP;
+        const int gy = y / STEP;
+
+        if (exactCells[gy * (gridWidth - 1) + gx]) {
+            return false;
+        }
+
+        const double* const p0 = &grid[channel][(gy * gridWidth + gx) * 2];
+        const double* const p1 = p0 + gridWidth * 2;
+        const double fx = static_cast<double>(x - gx * STEP) / STEP;
+        const double fy = static_cast<double>(y - gy * STEP) / STEP;
+        const double w00 = (1.0 - fx) * (1.0 - fy);
+        const double w01 = fx * (1.0 - fy);
+        const double w10 = (1.0 - fx) * fy;
+        const double w11 = fx * fy;
+        mx = w00 * p0[0] + w01 * p0[2] + w10 * p1[0] + w11 * p1[2];
+        my = w00 * p0[1] + w01 * p0[3] + w10 * p1[1] + w11 * p1[3];
+        return true;
+    }
+
+private:
+    const int channels;
+    const int gridWidth;
+    const int gridHeight;
+    std::vector<double> grid[3];   // (x, y) of each grid point, per channel
+    std::vector<char> exactCells;  // cells where the interpolation isn't accurate enough
+};
+
+/**
+ * The warp maps of the last transformations, so that only the geometric parameters,
+ * and not every change of the other tools, cause the mapping to be evaluated again.
+ */
+class WarpMapCache final :
+    public NonCopyable
+{
+public:
+    struct Key {
+        int cx;
+        int cy;
+        int width;
+        int height;
+        int oW;
+        int oH;
+        int channels;
+        double ascale;
+        const FramesMetaData* metadata;
+        int rawRotationDeg;
+        procparams::CoarseTransformParams coarse;
+        procparams::CommonTransformParams commonTrans;
+        procparams::RotateParams rotate;
+        procparams::PerspectiveParams perspective;
+        procparams::LensProfParams lensProf;
+
+        bool operator ==(const Key& other) const;
+    };
+
+    /** @return the cached warp map for the key, calling build if there's none */
+    std::shared_ptr<const WarpMap> get(const Key& key, const std::function<WarpMap*()>& build);
+
+private:
+    static constexpr std::size_t MAX_ENTRIES = 4; // the preview and the detail windows
+
+    MyMutex mutex;
+    std::vector<std::pair<Key, std::shared_ptr<const WarpMap>>> entries; // most recently used first
+};
+
+}
@@ -49,18 +49,54 @@ namespace rtexif
 
 Interpreter stdInterpreter;
 
+//--------------- class ExifSource --------------------------------------------
+// memory mapped view of a file, read through a stream on the mapped memory
+//-----------------------------------------------------------------------------
+
+ExifSource::ExifSource (GMappedFile* m, FILE* f)
+    : mapped (m), file (f) {}
+
+ExifSource::~ExifSource ()
+{
+    fclose (file);
+    g_mapped_file_unref (mapped);
+}
+
+std::shared_ptr<ExifSource> ExifSource::create (FILE* f)
+{
+#ifdef WIN32
+    // no fmemopen() available, the file is read directly
+    return nullptr;
+#else
+    GMappedFile* const m = g_mapped_file_new_from_fd (fileno (f), FALSE, nullptr);
+
+    if (!m) {
+        return nullptr;
+    }
+
+    FILE* const mf = g_mapped_file_get_length (m) ? fmemopen (g_mapped_file_get_contents (m), g_mapped_file_get_length (m), "rb") : nullptr;
+
+    if (!mf) {
+        g_mapped_file_unref (m);
+        return nullptr;
+    }
+
+    return std::shared_ptr<ExifSource> (new ExifSource (m, mf));
+#endif
+}
+
 //--------------- class TagDirectory ------------------------------------------
 // this class is a collection (an array) of tags
 //-----------------------------------------------------------------------------
 
 TagDirectory::TagDirectory ()
-    : attribs (ifdAttribs), order (HOSTORDER), parent (nullptr), parseJPEG(true) {}
+    : attribs (ifdAttribs), order (HOSTORDER), parent (nullptr), parseJPEG(true), indexed(false), base(0) {}
 
 TagDirectory::TagDirectory (TagDirectory* p, const TagAttrib* ta, ByteOrder border)
-    : attribs (ta), order (border), parent (p), parseJPEG(true) {}
+    : attribs (ta), order (border), parent (p), parseJPEG(true), indexed(false), base(0) {}
 
-TagDirectory::TagDirectory (TagDirectory* p, FILE* f, int base, const TagAttrib* ta, ByteOrder border, bool skipIgnored, bool parseJpeg)
-    : attribs (ta), order (border), parent (p), parseJPEG(parseJpeg)
+TagDirectory::TagDirectory (TagDirectory* p, FILE* f, int base, const TagAttrib* ta, ByteOrder border, bool skipIgnored, bool parseJpeg, std::shared_ptr<ExifSource> src)
+    : attribs (ta), order (border), parent (p), parseJPEG(parseJpeg), source(std::move(src)), indexed(false), base(base)
 {
 
     int numOfTags = get2 (f, order);
@@ -108,6 +144,156 @@ TagDirectory::~TagDirectory ()
     for (size_t i = 0; i < tags.size(); i++) {
         delete tags[i];
     }
+
+    for (const auto& entry : pending) {
+        delete entry.tag;
+    }
+}
+
+TagDirectory* TagDirectory::createIndexed (TagDirectory* p, FILE* f, int base, const TagAttrib* ta, ByteOrder border, bool parseJpeg)
+{
+    const std::shared_ptr<ExifSource> src = p ? p->getRoot()->getSource() : nullptr;
+
+    if (!src || src->getFile() != f) {
+        return new TagDirectory (p, f, base, ta, border, true, parseJpeg);
+    }
+
+    TagDirectory* dir = new TagDirectory (p, ta, border);
+    dir->parseJPEG = parseJpeg;
+    dir->source = src;
+    dir->indexed = true;
+    dir->base = base;
+    dir->index (f);
+    return dir;
+}
+
+void TagDirectory::index (FILE* f)
+{
+    // only store the position of the IFD entries, filtered like in the parsing constructor
+    int numOfTags = get2 (f, order);
+
+    if (numOfTags <= 0 || numOfTags > 1000) {
+        return;
+    }
+
+    pending.reserve (numOfTags);
+    unsigned char entry[12];
+
+    for (int i = 0; i < numOfTags; i++) {
+        const long position = ftell (f);
+
+        if (fread (entry, 1, 12, f) != 12) {
+            break;
+        }
+
+        const unsigned short id = sget2 (entry, order);
+        const int type = sget2 (entry + 2, order);
+        const unsigned int count = sget4 (entry + 4, order);
+
+        if (type < 1 || type > 14 || count > 10 * 1024 * 1024) {
+            continue;
+        }
+
+        const TagAttrib* attrib = getAttrib (id);
+
+        if (!attrib || attrib->ignore == 1) {
+            continue;
+        }
+
+        bool duplicate = false;
+
+        for (const auto& other : pending) {
+            if (other.id == id) {
+                duplicate = true;
+                break;
+            }
+        }
+
+        if (!duplicate) {
+            pending.push_back ({id, attrib->subdirAttribs || id == 0x927C || id == 0xc634, false, position, nullptr});
+        }
+    }
+}
+
+Tag* TagDirectory::parsePending (PendingTag &entry) const
+{
+    // has to be called with the mutex of the source locked
+    if (!entry.parsed) {
+        FILE* const f = source->getFile();
+        // the stream may be in use by the parser of the parent directories
+        const long savedPosition = ftell (f);
+        fseek (f, entry.position, SEEK_SET);
+        entry.tag = new Tag (const_cast<TagDirectory*> (this), f, base);
+        fseek (f, savedPosition, SEEK_SET);
+
+        // filter out tags with unknown type
+        if ((int)entry.tag->getType() == 0) {
+            delete entry.tag;
+            entry.tag = nullptr;
+        }
+
+        entry.parsed = true;
+    }
+
+    return entry.tag;
+}
+
+void TagDirectory::parseAllPending () const
+{
+    if (!indexed) {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock (source->getMutex());
+
+    if (pending.empty()) {
+        return;
+    }
+
+    // tags added after indexing come after the ones from the file, like in a parsed directory
+    std::vector<Tag*> allTags;
+    allTags.reserve (pending.size() + tags.size());
+
+    for (auto& entry : pending) {
+        Tag* const tag = parsePending (entry);
+
+        if (tag) {
+            allTags.push_back (tag);
+        }
+    }
+
+    allTags.insert (allTags.end(), tags.begin(), tags.end());
+    tags.swap (allTags);
+    pending.clear ();
+}
+
+std::vector<Tag*> TagDirectory::getDirectoryTags () const
+{
+    // only the pending tags which can have subdirectories are parsed
+    std::vector<Tag*> dirTags;
+    std::unique_lock<std::recursive_mutex> lock;
+
+    if (indexed) {
+        lock = std::unique_lock<std::recursive_mutex> (source->getMutex());
+    }
+
+    for (auto tag : tags) {
+        if (tag->isDirectory()) {
+            dirTags.push_back (tag);
+        }
+    }
+
+    for (auto& entry : pending) {
+        if (entry.subdir) {
+            Tag* const tag = parsePending (entry);
+
+            if (tag && tag->isDirectory()) {
+                dirTags.push_back (tag);
+            }
+        }
+    }
+
+    return dirTags;
 }
 
 class CompareTags
@@ -122,6 +308,7 @@ public:
 void TagDirectory::sort ()
 {
 
+    parseAllPending ();
     std::sort (tags.begin(), tags.end(), CompareTags());
 
     for (size_t i = 0; i < tags.size(); i++)
@@ -199,6 +386,7 @@ const TagAttrib* TagDirectory::getAttribP (const char* name)
 
 void TagDirectory::printAll (unsigned int level) const
 {
+    parseAllPending ();
 
     // set the spacer prefix string
     char prefixStr[level * 4 + 1];
@@ -311,6 +499,8 @@ bool TagDirectory::CPBDump (const Glib::ustring &commFName, const Glib::ustring
     }
 
     // recursively iterate over the tag list
+    parseAllPending ();
+
     for (size_t i = 0; i < tags.size(); i++) {
         std::string tagName = tags[i]->nameToString ();
 
@@ -367,6 +557,7 @@ Glib::ustring TagDirectory::getDumpKey (int tagID, const Glib::ustring &tagName)
 }
 void TagDirectory::addTag (Tag* &tag)
 {
+    parseAllPending ();
 
     // look up if it already exists:
     if (getTag (tag->getID())) {
@@ -379,6 +570,7 @@ void TagDirectory::addTag (Tag* &tag)
 
 void TagDirectory::addTagFront (Tag* &tag)
 {
+    parseAllPending ();
 
     // look up if it already exists:
     if (getTag (tag->getID())) {
@@ -391,6 +583,7 @@ void TagDirectory::addTagFront (Tag* &tag)
 
 void TagDirectory::replaceTag (Tag* tag)
 {
+    parseAllPending ();
 
     // look up if it already exists:
     for (size_t i = 0; i < tags.size(); i++)
@@ -405,12 +598,22 @@ void TagDirectory::replaceTag (Tag* tag)
 
 Tag* TagDirectory::getTag (int ID) const
 {
+    std::unique_lock<std::recursive_mutex> lock;
+
+    if (indexed) {
+        lock = std::unique_lock<std::recursive_mutex> (source->getMutex());
+    }
 
     for (size_t i = 0; i < tags.size(); i++)
         if (tags[i]->getID() == ID) {
             return tags[i];
         }
 
+    for (auto& entry : pending)
+        if (entry.id == ID) {
+            return parsePending (entry);
+        }
+
     return nullptr;
 }
 
@@ -471,7 +674,7 @@ Tag* TagDirectory::findTag (const char* name, bool lookUpward) const
     Tag* foundTag = nullptr;
     int tagDistance = 10000;
 
-    for (auto tag : tags) {
+    for (auto tag : getDirectoryTags()) {
         if (tag->isDirectory()) {
             TagDirectory *dir;
             int i = 0;
@@ -518,7 +721,7 @@ std::vector<const Tag*> TagDirectory::findTags (int ID)
         tagList.push_back(t);
     }
 
-    for (auto tag : tags) {
+    for (auto tag : getDirectoryTags()) {
         if (tag->isDirectory()) {
             TagDirectory *dir;
             int i = 0;
@@ -551,7 +754,7 @@ std::vector<const Tag*> TagDirectory::findTags (const char* name)
         tagList.push_back(t);
     }
 
-    for (auto tag : tags) {
+    for (auto tag : getDirectoryTags()) {
         if (tag->isDirectory()) {
             TagDirectory *dir;
             int i = 0;
@@ -654,6 +857,7 @@ bool TagDirectory::getXMPTagValue (const char* name, char* value) const
 
 void TagDirectory::keepTag (int ID)
 {
+    parseAllPending ();
     for (size_t i = 0; i < tags.size(); i++)
         if (tags[i]->getID() == ID) {
             tags[i]->setKeep (true);
@@ -662,6 +866,7 @@ void TagDirectory::keepTag (int ID)
 
 int TagDirectory::calculateSize ()
 {
+    parseAllPending ();
 
     int size = 2; // space to store the number of tags
 
@@ -676,6 +881,7 @@ int TagDirectory::calculateSize ()
 
 TagDirectory* TagDirectory::clone (TagDirectory* parent) const
 {
+    parseAllPending ();
 
     TagDirectory* td = new TagDirectory (parent, attribs, order);
 
@@ -688,6 +894,7 @@ TagDirectory* TagDirectory::clone (TagDirectory* parent) const
 
 int TagDirectory::write (int start, unsigned char* buffer)
 {
+    parseAllPending ();
 
     int size = calculateSize ();
     int tagnum = 0;
@@ -727,6 +934,7 @@ int TagDirectory::write (int start, unsigned char* buffer)
 
 void TagDirectory::applyChange (const std::string &name, const Glib::ustring &value)
 {
+    parseAllPending ();
 
     std::string::size_type dp = name.find_first_of ('.');
     std::string fseg = name.substr (0, dp);
@@ -1261,6 +1469,8 @@ defsubdirs:
 
 bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
 {
+    // maker notes are large and only few of their tags are usually needed,
+    // so their directories are indexed only and the tags are parsed on first access if possible
     value = nullptr;
     Tag* tmake = parent->getRoot()->findTag ("Make");
     std::string make ( tmake ? tmake->valueToString() : "");
@@ -1280,13 +1490,13 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
             value = new unsigned char[8];
             fread (value, 1, 8, f);
             directory = new TagDirectory*[2];
-            directory[0] = new TagDirectory (parent, f, base, nikon2Attribs, bom);
+            directory[0] = TagDirectory::createIndexed (parent, f, base, nikon2Attribs, bom);
             directory[1] = nullptr;
         } else if ( model.find ("NIKON E990") != std::string::npos ||
                     (model.find ("NIKON D1") != std::string::npos && model.size() > 8 && model.at (8) != '0')) {
             makerNoteKind = IFD;
             directory = new TagDirectory*[2];
-            directory[0] = new TagDirectory (parent, f, base, nikon3Attribs, bom);
+            directory[0] = TagDirectory::createIndexed (parent, f, base, nikon3Attribs, bom);
             directory[1] = nullptr;
         } else {
             // needs refinement! (embedded tiff header parsing)
@@ -1305,13 +1515,13 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
                 MakerNoteOrder = rtexif::INTEL;
             }
 
-            directory[0] = new TagDirectory (parent, f, basepos + 10, nikon3Attribs, MakerNoteOrder);
+            directory[0] = TagDirectory::createIndexed (parent, f, basepos + 10, nikon3Attribs, MakerNoteOrder);
             directory[1] = nullptr;
         }
     } else if ( make.find ( "Canon" ) != std::string::npos  ) {
         makerNoteKind = IFD;
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, base, canonAttribs, bom);
+        directory[0] = TagDirectory::createIndexed (parent, f, base, canonAttribs, bom);
         directory[1] = nullptr;
     } else if ( make.find ( "PENTAX" ) != std::string::npos ) {
         makerNoteKind = HEADERIFD;
@@ -1319,7 +1529,7 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
         value = new unsigned char[6];
         fread (value, 1, 6, f);
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, base, pentaxAttribs, bom);
+        directory[0] = TagDirectory::createIndexed (parent, f, base, pentaxAttribs, bom);
         directory[1] = nullptr;
     } else if ( (make.find ( "RICOH" ) != std::string::npos ) && (model.find ("PENTAX") != std::string::npos) ) {
         makerNoteKind = HEADERIFD;
@@ -1327,7 +1537,7 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
         value = new unsigned char[10];
         fread (value, 1, 10, f);
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, ftell (f) - 10, pentaxAttribs, bom);
+        directory[0] = TagDirectory::createIndexed (parent, f, ftell (f) - 10, pentaxAttribs, bom);
         directory[1] = nullptr;
     } else if ( make.find ( "FUJIFILM" ) != std::string::npos ) {
         makerNoteKind = FUJI;
@@ -1335,12 +1545,12 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
         value = new unsigned char[12];
         fread (value, 1, 12, f);
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, ftell (f) - 12, fujiAttribs, INTEL);
+        directory[0] = TagDirectory::createIndexed (parent, f, ftell (f) - 12, fujiAttribs, INTEL);
         directory[1] = nullptr;
     } else if ( make.find ( "KONICA MINOLTA" ) != std::string::npos || make.find ( "Minolta" ) != std::string::npos ) {
         makerNoteKind = IFD;
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, base, minoltaAttribs, bom);
+        directory[0] = TagDirectory::createIndexed (parent, f, base, minoltaAttribs, bom);
         directory[1] = nullptr;
     } else if ( make.find ( "SONY" ) != std::string::npos ) {
         valuesize = 12;
@@ -1355,7 +1565,7 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
         }
 
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, base, sonyAttribs, bom );
+        directory[0] = TagDirectory::createIndexed (parent, f, base, sonyAttribs, bom );
         directory[1] = nullptr;
     } else if ( make.find ( "OLYMPUS" ) != std::string::npos ) {
         makerNoteKind = HEADERIFD;
@@ -1369,9 +1579,9 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
             makerNoteKind = OLYMPUS2;
             fread (value + 8, 1, 4, f);
             valuesize = 12;
-            directory[0] = new TagDirectory (parent, f, ftell (f) - 12, olympusAttribs, value[8] == 'I' ? INTEL : MOTOROLA);
+            directory[0] = TagDirectory::createIndexed (parent, f, ftell (f) - 12, olympusAttribs, value[8] == 'I' ? INTEL : MOTOROLA);
         } else {
-            directory[0] = new TagDirectory (parent, f, base, olympusAttribs, bom);
+            directory[0] = TagDirectory::createIndexed (parent, f, base, olympusAttribs, bom);
         }
     } else if ( make.find ( "Panasonic" ) != std::string::npos) {
         makerNoteKind = HEADERIFD;
@@ -1379,7 +1589,7 @@ bool Tag::parseMakerNote (FILE* f, int base, ByteOrder bom )
         value = new unsigned char[12];
         fread (value, 1, 12, f);
         directory = new TagDirectory*[2];
-        directory[0] = new TagDirectory (parent, f, base, panasonicAttribs, bom, true, parent->getParseJpeg());
+        directory[0] = TagDirectory::createIndexed (parent, f, base, panasonicAttribs, bom, true, parent->getParseJpeg());
         directory[1] = nullptr;
     } else {
         return false;
@@ -2136,6 +2346,11 @@ void ExifManager::setIFDOffset(unsigned int offset)
     IFDOffset = offset;
 }
 
+void ExifManager::setMapped(bool m)
+{
+    mapped = m;
+}
+
 void ExifManager::parseCIFF ()
 {
 
@@ -2820,6 +3035,14 @@ void ExifManager::parse (bool isRaw, bool skipIgnored, bool parseJpeg)
     }
     setlocale (LC_NUMERIC, "C"); // to set decimal point in sscanf
 
+    // read from a mapped view of the file, it stays alive as long as lazily indexed directories need it
+    const std::shared_ptr<ExifSource> source = mapped ? ExifSource::create (f) : nullptr;
+    FILE* const fileHandle = f;
+
+    if (source) {
+        f = source->getFile();
+    }
+
     if (order == ByteOrder::UNKNOWN) {
         // read tiff header
         fseek (f, rml->exifBase, SEEK_SET);
@@ -2837,7 +3060,7 @@ void ExifManager::parse (bool isRaw, bool skipIgnored, bool parseJpeg)
         fseek (f, rml->exifBase + ifdOffset, SEEK_SET);
 
         // first read the IFD directory
-        TagDirectory* root =  new TagDirectory (nullptr, f, rml->exifBase, ifdAttribs, order, skipIgnored, parseJpeg);
+        TagDirectory* root =  new TagDirectory (nullptr, f, rml->exifBase, ifdAttribs, order, skipIgnored, parseJpeg, source);
 
         // fix ISO issue with nikon and panasonic cameras
         Tag* make = root->getTag ("Make");
@@ -3156,6 +3379,8 @@ void ExifManager::parse (bool isRaw, bool skipIgnored, bool parseJpeg)
 
     } while (ifdOffset > 0 && !onlyFirst);
 
+    f = fileHandle;
+
     // Security check : if there's at least one root, there must be at least one image.
     // If the following occurs, then image detection above has failed or it's an unsupported file type.
     // Yet the result of this should be valid.
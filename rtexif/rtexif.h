@@ -25,10 +25,12 @@
 #include <iomanip>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include <glib.h>
 #include <glibmm/ustring.h>
 
 #include "../rtengine/noncopyable.h"
@@ -110,24 +112,79 @@ struct TagAttrib {
 
 const TagAttrib* lookupAttrib (const TagAttrib* dir, const char* field);
 
+/// Memory mapped view of a file the metadata are parsed from.
+/// It is kept alive by the directories which parse their tags on first access.
+class ExifSource :
+    public rtengine::NonCopyable
+{
+    GMappedFile*         mapped;
+    FILE*                file;    // stream reading from the mapped memory
+    std::recursive_mutex mutex;   // serializes the accesses to 'file'
+
+    ExifSource (GMappedFile* m, FILE* f);
+
+public:
+    ~ExifSource ();
+
+    // Returns NULL if the file can't be mapped, the caller has to read from 'f' then
+    static std::shared_ptr<ExifSource> create (FILE* f);
+
+    FILE* getFile ()
+    {
+        return file;
+    }
+    std::recursive_mutex& getMutex ()
+    {
+        return mutex;
+    }
+};
+
 /// A directory of tags
 class TagDirectory
 {
 
 protected:
-    std::vector<Tag*> tags;         // tags in the directory
+    mutable std::vector<Tag*> tags; // tags in the directory (lazily indexed directories add their tags on demand)
     const TagAttrib*  attribs;      // descriptor table to decode the tags
     ByteOrder         order;        // byte order
     TagDirectory*     parent;       // parent directory (NULL if root)
     bool              parseJPEG;
     static Glib::ustring getDumpKey (int tagID, const Glib::ustring &tagName);
 
+    // An IFD entry of a lazily indexed directory
+    struct PendingTag {
+        unsigned short id;
+        bool           subdir;      // true if the tag can have subdirectories
+        bool           parsed;
+        long           position;    // position of the IFD entry in the file
+        Tag*           tag;         // parsed tag, NULL if not parsed yet or invalid
+    };
+
+    std::shared_ptr<ExifSource> source; // mapped file the directory tree is parsed from (NULL if not mapped)
+    bool              indexed;      // true if the tags are parsed on first access
+    int               base;         // base offset of the values of the pending tags
+    mutable std::vector<PendingTag> pending; // IFD entries not yet moved to 'tags'
+
+    void        index           (FILE* f);
+    Tag*        parsePending    (PendingTag &entry) const;
+    void        parseAllPending () const;
+    std::vector<Tag*> getDirectoryTags () const;
+
 public:
     TagDirectory ();
-    TagDirectory (TagDirectory* p, FILE* f, int base, const TagAttrib* ta, ByteOrder border, bool skipIgnored = true, bool parseJpeg = true);
+    TagDirectory (TagDirectory* p, FILE* f, int base, const TagAttrib* ta, ByteOrder border, bool skipIgnored = true, bool parseJpeg = true, std::shared_ptr<ExifSource> src = nullptr);
     TagDirectory (TagDirectory* p, const TagAttrib* ta, ByteOrder border);
     virtual ~TagDirectory ();
 
+    // Creates a directory which only indexes its IFD entries and parses the tags on first access.
+    // Falls back to a fully parsed directory if the tree is not read from a mapped file.
+    static TagDirectory* createIndexed (TagDirectory* p, FILE* f, int base, const TagAttrib* ta, ByteOrder border, bool parseJpeg = true);
+
+    const std::shared_ptr<ExifSource>& getSource () const
+    {
+        return source;
+    }
+
     inline ByteOrder getOrder      () const
     {
         return order;
@@ -143,6 +200,7 @@ public:
     TagDirectory*    getRoot       ();
     inline int       getCount      () const
     {
+        parseAllPending ();
         return tags.size ();
     }
     const TagAttrib* getAttrib     (int id) const;
@@ -179,6 +237,7 @@ public:
     void        replaceTag    (Tag* a);
     inline Tag* getTagByIndex (int ix)
     {
+        parseAllPending ();
         return tags[ix];
     }
     inline void      setOrder      (ByteOrder bo)
@@ -358,15 +417,17 @@ public:
     std::unique_ptr<rtengine::RawMetaDataLocation> rml;
     ByteOrder order;
     bool onlyFirst;  // Only first IFD
+    bool mapped;     // parse from a memory mapped view of the file and index the maker notes lazily
     unsigned int IFDOffset;
     std::vector<TagDirectory*> roots;
     std::vector<TagDirectory*> frames;
 
     ExifManager (FILE* fHandle, std::unique_ptr<rtengine::RawMetaDataLocation> _rml, bool onlyFirstIFD)
         : f(fHandle), rml(std::move(_rml)), order(UNKNOWN), onlyFirst(onlyFirstIFD),
-          IFDOffset(0) {}
+          mapped(false), IFDOffset(0) {}
 
     void setIFDOffset(unsigned int offset);
+    void setMapped(bool m);
 
 
     void parseRaw (bool skipIgnored = true);
@@ -18,6 +18,7 @@
  */
 #include <glibmm/ustring.h>
 #include <glib/gstdio.h>
+#include <algorithm>
 #include <cstring>
 #include <functional>
 #include "../rtengine/rt_math.h"
@@ -431,6 +432,7 @@ void BatchQueue::cancelItems (const std::vector<ThumbBrowserEntryBase*>& items)
                 continue;
 
             fd.erase (pos);
+            invalidateArrangement ();
 
             rtengine::ProcessingJob::destroy (entry->job);
 
@@ -495,6 +497,7 @@ void BatchQueue::headItems (const std::vector<ThumbBrowserEntryBase*>& items)
                 continue;
 
             fd.erase (pos);
+            invalidateArrangement ();
 
             // find the first item that is not under processing
             const auto newPos = std::find_if (fd.begin (), fd.end (), [] (const ThumbBrowserEntryBase* fdEntry) { return !fdEntry->processing; });
@@ -526,6 +529,7 @@ void BatchQueue::tailItems (const std::vector<ThumbBrowserEntryBase*>& items)
                 continue;
 
             fd.erase (pos);
+            invalidateArrangement ();
 
             fd.push_back (entry);
         }
@@ -609,6 +613,7 @@ void BatchQueue::startProcessing ()
             next->removeButtonSet ();
 
             // start batch processing
+            setExtraOutputs(next);
             rtengine::startBatchProcessing (next->job, this);
             queue_draw ();
 
@@ -667,9 +672,47 @@ void BatchQueue::error(const Glib::ustring& descr)
     }
 }
 
+void BatchQueue::setExtraOutputs(BatchQueueEntry* entry)
+{
+    const SaveFormat& mainFormat = !entry->outFileName.empty() && entry->forceFormatOpts ? entry->saveFormat : options.saveFormatBatch;
+    extraOutputs = ExtraOutput::parseList(options.extraOutputsBatch, mainFormat);
+
+    if (!extraOutputs.empty()) {
+        entry->job->setExtraOutputs(ExtraOutput::getOutputSpecs(extraOutputs, *entry->params));
+    }
+}
+
+int BatchQueue::saveImage(rtengine::IImagefloat* img, const Glib::ustring& fname, const SaveFormat& saveFormat)
+{
+    int err = 0;
+
+    if (saveFormat.format == "tif") {
+        err = img->saveAsTIFF (
+            fname,
+            saveFormat.tiffBits,
+            saveFormat.tiffFloat,
+            saveFormat.tiffUncompressed,
+            saveFormat.bigTiff
+        );
+    } else if (saveFormat.format == "png") {
+        err = img->saveAsPNG (fname, saveFormat.pngBits);
+    } else if (saveFormat.format == "jpg") {
+        err = img->saveAsJPEG (fname, saveFormat.jpegQuality, saveFormat.jpegSubSamp);
+    }
+
+    delete img;
+    return err;
+}
+
 rtengine::ProcessingJob* BatchQueue::imageReady(rtengine::IImagefloat* img)
 {
-    // save image img
+    return imagesReady({img});
+}
+
+rtengine::ProcessingJob* BatchQueue::imagesReady(const std::vector<rtengine::IImagefloat*>& imgs)
+{
+    // save the images, the first one being the main output
+    rtengine::IImagefloat* const img = imgs[0];
     Glib::ustring fname;
     SaveFormat saveFormat;
 
@@ -692,27 +735,33 @@ rtengine::ProcessingJob* BatchQueue::imageReady(rtengine::IImagefloat* img)
 
     //printf ("fname=%s, %s\n", fname.c_str(), removeExtension(fname).c_str());
 
-    if (img && !fname.empty()) {
-        int err = 0;
-
-        if (saveFormat.format == "tif") {
-            err = img->saveAsTIFF (
-                fname,
-                saveFormat.tiffBits,
-                saveFormat.tiffFloat,
-                saveFormat.tiffUncompressed,
-                saveFormat.bigTiff
-            );
-        } else if (saveFormat.format == "png") {
-            err = img->saveAsPNG (fname, saveFormat.pngBits);
-        } else if (saveFormat.format == "jpg") {
-            err = img->saveAsJPEG (fname, saveFormat.jpegQuality, saveFormat.jpegSubSamp);
+    // saveImage() deletes the images it saves, the others are deleted here
+    const size_t saved = img && !fname.empty() ? std::min(imgs.size(), extraOutputs.size() + 1) : 0;
+
+    for (size_t i = saved; i < imgs.size(); ++i) {
+        delete imgs[i];
+    }
+
+    if (saved) {
+        Glib::ustring failed;
+
+        if (saveImage(img, fname, saveFormat)) {
+            failed = fname;
         }
 
-        delete img;
+        const Glib::ustring fnameBase = removeExtension(fname);
+
+        for (size_t i = 1; i < saved; ++i) {
+            const ExtraOutput& extra = extraOutputs[i - 1];
+            const Glib::ustring extraName = autoCompleteFileName(fnameBase + extra.suffix, extra.saveFormat.format);
 
-        if (err) {
-            throw Glib::FileError(Glib::FileError::FAILED, M("MAIN_MSG_CANNOTSAVE") + "\n" + fname);
+            if (saveImage(imgs[i], extraName, extra.saveFormat) && failed.empty()) {
+                failed = extraName;
+            }
+        }
+
+        if (!failed.empty()) {
+            throw Glib::FileError(Glib::FileError::FAILED, M("MAIN_MSG_CANNOTSAVE") + "\n" + failed);
         }
 
         if (saveFormat.saveParams) {
@@ -741,6 +790,7 @@ rtengine::ProcessingJob* BatchQueue::imageReady(rtengine::IImagefloat* img)
         processing = nullptr;
 
         fd.erase (fd.begin());
+        invalidateArrangement ();
 
         // return next job
         if (!fd.empty() && listener && listener->canStartNext ()) {
@@ -800,6 +850,10 @@ rtengine::ProcessingJob* BatchQueue::imageReady(rtengine::IImagefloat* img)
         }
     }
 
+    if (processing) {
+        setExtraOutputs(processing);
+    }
+
     redraw ();
     notifyListener ();
 
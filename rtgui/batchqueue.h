@@ -21,6 +21,7 @@
 
 #include <gtkmm.h>
 
+#include "extraoutput.h"
 #include "lwbutton.h"
 #include "lwbuttonset.h"
 #include "threadutils.h"
@@ -73,6 +74,7 @@ public:
     void setProgressState(bool inProcessing) override;
     void error(const Glib::ustring& descr) override;
     rtengine::ProcessingJob* imageReady(rtengine::IImagefloat* img) override;
+    rtengine::ProcessingJob* imagesReady(const std::vector<rtengine::IImagefloat*>& imgs) override;
 
     void rightClicked () override;
     void doubleClicked (ThumbBrowserEntryBase* entry) override;
@@ -98,6 +100,8 @@ private:
 
     Glib::ustring autoCompleteFileName (const Glib::ustring& fileName, const Glib::ustring& format);
     Glib::ustring getTempFilenameForParams( const Glib::ustring &filename );
+    void setExtraOutputs(BatchQueueEntry* entry);
+    static int saveImage(rtengine::IImagefloat* img, const Glib::ustring& fname, const SaveFormat& saveFormat);
     bool saveBatchQueue ();
     void notifyListener ();
 
@@ -108,6 +112,7 @@ private:
     int sequence; // holds the current sequence index
 
     Glib::ustring nameTemplate;
+    std::vector<ExtraOutput> extraOutputs; // of the currently processed image
 
     MyImageMenuItem* cancel;
     MyImageMenuItem* head;
@@ -0,0 +1,529 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include "cliserver.h"
+
+#include "options.h"
+#include "pathutils.h"
+
+#include "../rtengine/cJSON.h"
+#include "../rtengine/mytime.h"
+#include "../rtengine/procparams.h"
+#include "../rtengine/profilestore.h"
+#include "../rtengine/rtengine.h"
+
+namespace
+{
+
+void deleteProfile(const rtengine::procparams::PartialProfile* profile)
+{
+    const_cast<rtengine::procparams::PartialProfile*>(profile)->deleteInstance();
+    delete profile;
+}
+
+bool getString(const cJSON* root, const char* name, std::string& value)
+{
+    const cJSON* const item = cJSON_GetObjectItem(root, name);
+
+    if (!item) {
+        return true;
+    }
+
+    if (!cJSON_IsString(item)) {
+        return false;
+    }
+
+    value = item->valuestring;
+    return true;
+}
+
+bool getInt(const cJSON* root, const char* name, int& value)
+{
+    const cJSON* const item = cJSON_GetObjectItem(root, name);
+
+    if (!item) {
+        return true;
+    }
+
+    if (!cJSON_IsNumber(item)) {
+        return false;
+    }
+
+    value = item->valueint;
+    return true;
+}
+
+bool getBool(const cJSON* root, const char* name, bool& value)
+{
+    const cJSON* const item = cJSON_GetObjectItem(root, name);
+
+    if (!item) {
+        return true;
+    }
+
+    if (!cJSON_IsBool(item)) {
+        return false;
+    }
+
+    value = cJSON_IsTrue(item);
+    return true;
+}
+
+double toMs(int usec)
+{
+    return usec / 1000.0;
+}
+
+// Hash and size of the content of the file, the modification time isn't precise enough to catch a file rewritten within the same second
+bool getContentStamp(const Glib::ustring& fname, std::size_t& hash, std::size_t& size)
+{
+    try {
+        const std::string content = Glib::file_get_contents(fname);
+        hash = std::hash<std::string>()(content);
+        size = content.size();
+        return true;
+    } catch (const Glib::Error&) {
+        return false;
+    }
+}
+
+}
+
+CliServer::CliServer(unsigned int maxJobs) :
+    maxJobs(std::max(maxJobs, 1U)),
+    closing(false),
+    errors(0)
+{
+}
+
+unsigned int CliServer::run()
+{
+    std::vector<Glib::Threads::Thread*> workers;
+
+    for (unsigned int i = 0; i < maxJobs; ++i) {
+        workers.push_back(Glib::Threads::Thread::create(sigc::mem_fun(*this, &CliServer::worker)));
+    }
+
+    std::cerr << "Waiting for jobs, " << maxJobs << " at a time." << std::endl;
+
+    std::string line;
+
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        Job job;
+        Result result;
+
+        if (!parseJob(line, job, result.error)) {
+            result.input = job.input;
+            report(job, result);
+
+            Glib::Threads::Mutex::Lock lock(queueMutex);
+            ++errors;
+            continue;
+        }
+
+        Glib::Threads::Mutex::Lock lock(queueMutex);
+        queue.push_back(std::move(job));
+        queueCond.signal();
+    }
+
+    {
+        Glib::Threads::Mutex::Lock lock(queueMutex);
+        closing = true;
+        queueCond.broadcast();
+    }
+
+    for (auto worker : workers) {
+        worker->join();
+    }
+
+    return errors;
+}
+
+bool CliServer::parseJob(const std::string& line, Job& job, std::string& error) const
+{
+    cJSON* const root = cJSON_Parse(line.c_str());
+
+    if (!root || !cJSON_IsObject(root)) {
+        cJSON_Delete(root);
+        error = "malformed job";
+        return false;
+    }
+
+    std::string input;
+    std::string output;
+    bool ok =
+        getString(root, "id", job.id)
+        && getString(root, "input", input)
+        && getString(root, "output", output)
+        && getString(root, "format", job.format)
+        && getInt(root, "quality", job.quality)
+        && getInt(root, "subsampling", job.subsampling)
+        && getInt(root, "bits", job.bits)
+        && getBool(root, "default", job.useDefault)
+        && getBool(root, "sidecar", job.sidecar)
+        && getBool(root, "float", job.isFloat)
+        && getBool(root, "compress", job.compress)
+        && getBool(root, "overwrite", job.overwrite)
+        && getBool(root, "fast", job.fast);
+
+    const cJSON* const profiles = cJSON_GetObjectItem(root, "profiles");
+
+    if (ok && profiles) {
+        if (cJSON_IsArray(profiles)) {
+            for (int i = 0; ok && i < cJSON_GetArraySize(profiles); ++i) {
+                const cJSON* const item = cJSON_GetArrayItem(profiles, i);
+                ok = cJSON_IsString(item);
+
+                if (ok) {
+                    job.profiles.emplace_back(item->valuestring);
+                }
+            }
+        } else {
+            ok = false;
+        }
+    }
+
+    const bool floatSet = cJSON_GetObjectItem(root, "float") != nullptr;
+
+    cJSON_Delete(root);
+
+    job.input = input;
+
+    if (!ok) {
+        error = "invalid job member";
+        return false;
+    }
+
+    if (job.input.empty()) {
+        error = "no input file";
+        return false;
+    }
+
+    if (job.format == "tiff") {
+        job.format = "tif";
+    } else if (job.format == "jpeg") {
+        job.format = "jpg";
+    }
+
+    if (job.format != "jpg" && job.format != "tif" && job.format != "png") {
+        error = "unsupported output format";
+        return false;
+    }
+
+    if (job.quality < 0 || job.quality > 100 || job.subsampling < 1 || job.subsampling > 3) {
+        error = "invalid JPEG quality or subsampling";
+        return false;
+    }
+
+    // the same depths as the extra outputs of the command line (see ExtraOutput::parse())
+    if (job.format == "jpg" && job.bits != -1 && job.bits != 8) {
+        error = "JPEG output is 8 bits";
+        return false;
+    }
+
+    if (job.bits == -1) {
+        job.bits = job.format == "tif" ? 16 : 8;
+    } else if (job.bits != 8 && job.bits != 16 && job.bits != 32) {
+        error = "invalid bit depth";
+        return false;
+    }
+
+    if (job.format == "png" && job.bits == 32) {
+        error = "PNG output is 8 or 16 bits";
+        return false;
+    }
+
+    if (job.format != "tif" && job.isFloat) {
+        error = "floating-point output is TIFF only";
+        return false;
+    }
+
+    if (job.bits == 32) {
+        if (floatSet && !job.isFloat) {
+            error = "32-bit TIFF output is floating-point only";
+            return false;
+        }
+
+        job.isFloat = true;
+    } else if (job.bits == 8 && job.isFloat) {
+        error = "floating-point TIFF output is 16 or 32 bits";
+        return false;
+    }
+
+    if (output.empty()) {
+        const Glib::ustring::size_type ext = job.input.find_last_of('.');
+        job.output = job.input.substr(0, ext) + "." + job.format;
+    } else {
+        job.output = output;
+    }
+
+    return true;
+}
+
+void CliServer::worker()
+{
+    while (true) {
+        Job job;
+
+        {
+            Glib::Threads::Mutex::Lock lock(queueMutex);
+
+            while (queue.empty() && !closing) {
+                queueCond.wait(queueMutex);
+            }
+
+            if (queue.empty()) {
+                return;
+            }
+
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        MyTime t1, t2;
+        t1.set();
+
+        Result result;
+        result.input = job.input;
+        result.output = job.output;
+        const bool ok = processJob(job, result);
+
+        t2.set();
+        result.totalTime = t2.etime(t1);
+
+        if (!ok) {
+            Glib::Threads::Mutex::Lock lock(queueMutex);
+            ++errors;
+        }
+
+        report(job, result);
+    }
+}
+
+bool CliServer::processJob(const Job& job, Result& result)
+{
+    MyTime t1, t2, t3, t4;
+    t1.set();
+
+    if (job.input == job.output) {
+        result.error = "cannot overwrite the input file";
+        return false;
+    }
+
+    if (!job.overwrite && Glib::file_test(job.output, Glib::FILE_TEST_EXISTS)) {
+        result.error = "output file already exists";
+        return false;
+    }
+
+    const Glib::ustring ext = getExtension(job.input).lowercase();
+    const bool isRaw = !(ext == "jpg" || ext == "jpeg" || ext == "tif" || ext == "tiff" || ext == "png");
+
+    // Profiles are resolved before loading the image, so that a missing profile fails early
+    std::vector<std::shared_ptr<const rtengine::procparams::PartialProfile>> jobProfiles;
+
+    for (const auto& fname : job.profiles) {
+        jobProfiles.push_back(getProfile(fname, false));
+
+        if (!jobProfiles.back()) {
+            result.error = "processing profile not found: " + fname;
+            return false;
+        }
+    }
+
+    Glib::ustring defProfile = isRaw ? options.defProfRaw : options.defProfImg;
+    std::shared_ptr<const rtengine::procparams::PartialProfile> defaultProfile;
+
+    if (job.useDefault && defProfile != DEFPROFILE_DYNAMIC) {
+        const Glib::ustring profPath = options.findProfilePath(defProfile);
+
+        if (!profPath.empty() && !(isRaw ? options.is_defProfRawMissing() : options.is_defProfImgMissing())) {
+            defaultProfile = getProfile(
+                profPath == DEFPROFILE_INTERNAL
+                    ? DEFPROFILE_INTERNAL
+                    : Glib::build_filename(profPath, Glib::path_get_basename(defProfile) + paramFileExtension),
+                isRaw
+            );
+        }
+
+        if (!defaultProfile) {
+            result.error = "default processing profile not found";
+            return false;
+        }
+    }
+
+    int errorCode;
+    rtengine::InitialImage* const ii = rtengine::InitialImage::load(job.input, isRaw, &errorCode, nullptr);
+
+    if (!ii) {
+        result.error = "error loading file";
+        return false;
+    }
+
+    t2.set();
+
+    // Has to be instantiated for each job to have a ProcParams object with default values
+    rtengine::procparams::ProcParams currentParams;
+
+    if (job.useDefault) {
+        if (defProfile == DEFPROFILE_DYNAMIC) {
+            defaultProfile.reset(ProfileStore::getInstance()->loadDynamicProfile(ii->getMetaData(), job.input), deleteProfile);
+        }
+
+        defaultProfile->applyTo(&currentParams);
+    }
+
+    for (const auto& profile : jobProfiles) {
+        profile->applyTo(&currentParams);
+    }
+
+    if (job.sidecar) {
+        const Glib::ustring sidecar = job.input + paramFileExtension;
+
+        // the "load" method doesn't reset the procparams values, so values found in the sidecar override the ones of currentParams
+        if (!Glib::file_test(sidecar, Glib::FILE_TEST_EXISTS) || currentParams.load(sidecar)) {
+            ii->decreaseRef();
+            result.error = "sidecar file not found";
+            return false;
+        }
+    }
+
+    rtengine::ProcessingJob* const pjob = rtengine::ProcessingJob::create(ii, currentParams, job.fast);
+
+    if (!pjob) {
+        ii->decreaseRef();
+        result.error = "error creating processing";
+        return false;
+    }
+
+    rtengine::IImagefloat* const resultImage = rtengine::processImage(pjob, errorCode, nullptr);
+
+    if (!resultImage) {
+        rtengine::ProcessingJob::destroy(pjob);
+        result.error = "error processing";
+        return false;
+    }
+
+    t3.set();
+
+    if (job.format == "jpg") {
+        errorCode = resultImage->saveAsJPEG(job.output, job.quality, job.subsampling);
+    } else if (job.format == "tif") {
+        errorCode = resultImage->saveAsTIFF(job.output, job.bits, job.isFloat, !job.compress);
+    } else {
+        errorCode = resultImage->saveAsPNG(job.output, job.bits);
+    }
+
+    ii->decreaseRef();
+    delete resultImage;
+
+    t4.set();
+
+    result.loadTime = t2.etime(t1);
+    result.processTime = t3.etime(t2);
+    result.saveTime = t4.etime(t3);
+
+    if (errorCode) {
+        result.error = "error saving file";
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const rtengine::procparams::PartialProfile> CliServer::getProfile(const Glib::ustring& fname, bool isRaw)
+{
+    std::size_t hash = 0;
+    std::size_t size = 0;
+
+    if (fname != DEFPROFILE_INTERNAL && !getContentStamp(fname, hash, size)) {
+        return nullptr;
+    }
+
+    // The full profile used as default for raw files isn't the same as the partial one used for the others
+    const Glib::ustring key = (isRaw ? "raw:" : "img:") + fname;
+
+    {
+        Glib::Threads::Mutex::Lock lock(profilesMutex);
+        const auto iter = profiles.find(key);
+
+        if (iter != profiles.end() && iter->second.hash == hash && iter->second.size == size) {
+            return iter->second.profile;
+        }
+    }
+
+    // Loaded outside of the lock, another worker loading the same profile only does it twice
+    std::shared_ptr<rtengine::procparams::PartialProfile> profile(
+        isRaw
+            ? new rtengine::procparams::PartialProfile(true, true)
+            : new rtengine::procparams::PartialProfile(true),
+        deleteProfile
+    );
+
+    if (profile->load(fname)) {
+        return nullptr;
+    }
+
+    // not cached if the file changed while it was being loaded
+    std::size_t loadedHash = 0;
+    std::size_t loadedSize = 0;
+
+    if (fname == DEFPROFILE_INTERNAL || (getContentStamp(fname, loadedHash, loadedSize) && loadedHash == hash && loadedSize == size)) {
+        Glib::Threads::Mutex::Lock lock(profilesMutex);
+        profiles[key] = {hash, size, profile};
+    }
+
+    return profile;
+}
+
+void CliServer::report(const Job& job, const Result& result)
+{
+    cJSON* const root = cJSON_CreateObject();
+
+    cJSON_AddStringToObject(root, "id", job.id.c_str());
+    cJSON_AddStringToObject(root, "input", result.input.c_str());
+    cJSON_AddStringToObject(root, "output", result.output.c_str());
+    cJSON_AddStringToObject(root, "status", result.error.empty() ? "ok" : "error");
+
+    if (!result.error.empty()) {
+        cJSON_AddStringToObject(root, "error", result.error.c_str());
+    }
+
+    cJSON_AddNumberToObject(root, "load_ms", toMs(result.loadTime));
+    cJSON_AddNumberToObject(root, "process_ms", toMs(result.processTime));
+    cJSON_AddNumberToObject(root, "save_ms", toMs(result.saveTime));
+    cJSON_AddNumberToObject(root, "total_ms", toMs(result.totalTime));
+
+    char* const text = cJSON_PrintUnformatted(root);
+
+    {
+        Glib::Threads::Mutex::Lock lock(outputMutex);
+        std::cout << text << std::endl;
+    }
+
+    cJSON_free(text);
+    cJSON_Delete(root);
+}
@@ -0,0 +1,128 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+#include <glibmm/ustring.h>
+
+#include "../rtengine/noncopyable.h"
+
+namespace rtengine
+{
+namespace procparams
+{
+class PartialProfile;
+}
+}
+
+/**
+ * Server mode of rawtherapee-cli.
+ *
+ * Jobs are read from the standard input, one JSON object per line, and processed by a pool of workers
+ * sharing the same engine, so that the engine initialization and the loading of the processing profiles
+ * are only done once. The result of each job is written to the standard output as a JSON object on its own line.
+ *
+ * Job members (only "input" is mandatory):
+ *   "id"          string echoed in the result
+ *   "input"       image to process
+ *   "output"      output file; by default, next to the input with the extension of the format
+ *   "profiles"    array of processing profiles, applied in order
+ *   "default"     apply the default raw or non-raw profile first (like -d)
+ *   "sidecar"     apply the sidecar profile last (like -s)
+ *   "format"      "jpg" (default), "tif" or "png"
+ *   "quality"     JPEG quality, 0-100
+ *   "subsampling" JPEG chroma subsampling, 1-3
+ *   "bits"        8, 16 or 32 bits per channel
+ *   "float"       floating-point TIFF output
+ *   "compress"    deflate compression for TIFF output
+ *   "overwrite"   overwrite the output file if it exists (like -Y)
+ *   "fast"        use the fast export pipeline (like -f)
+ *
+ * Result members: "id", "input", "output", "status" ("ok" or "error"), "error",
+ * and the "load_ms", "process_ms", "save_ms" and "total_ms" timings.
+ */
+class CliServer final :
+    public rtengine::NonCopyable
+{
+public:
+    /** @param maxJobs number of jobs processed concurrently */
+    explicit CliServer(unsigned int maxJobs);
+
+    /** Processes the jobs until the standard input is closed
+      * @return the number of failed jobs */
+    unsigned int run();
+
+private:
+    struct Job {
+        std::string id;
+        Glib::ustring input;
+        Glib::ustring output;
+        std::vector<Glib::ustring> profiles;
+        bool useDefault = false;
+        bool sidecar = false;
+        std::string format = "jpg";
+        int quality = 92;
+        int subsampling = 3;
+        int bits = -1;
+        bool isFloat = false;
+        bool compress = false;
+        bool overwrite = false;
+        bool fast = false;
+    };
+
+    struct Result {
+        Glib::ustring input;
+        Glib::ustring output;
+        std::string error;
+        int loadTime = 0;    ///< in microseconds, like the following ones
+        int processTime = 0;
+        int saveTime = 0;
+        int totalTime = 0;
+    };
+
+    struct CachedProfile {
+        std::size_t hash; ///< of the content of the file
+        std::size_t size;
+        std::shared_ptr<const rtengine::procparams::PartialProfile> profile;
+    };
+
+    bool parseJob(const std::string& line, Job& job, std::string& error) const;
+    void worker();
+    bool processJob(const Job& job, Result& result);
+    std::shared_ptr<const rtengine::procparams::PartialProfile> getProfile(const Glib::ustring& fname, bool isRaw);
+    void report(const Job& job, const Result& result);
+
+    const unsigned int maxJobs;
+
+    Glib::Threads::Mutex queueMutex;
+    Glib::Threads::Cond queueCond;
+    std::deque<Job> queue;
+    bool closing;
+    unsigned int errors;
+
+    Glib::Threads::Mutex profilesMutex;
+    std::map<Glib::ustring, CachedProfile> profiles;
+
+    Glib::Threads::Mutex outputMutex;
+};
@@ -25,6 +25,7 @@
 #include "imagearea.h"
 
 #include "../rtengine/dcrop.h"
+#include "../rtengine/iimage.h"
 #include "../rtengine/procparams.h"
 #include "../rtengine/refreshmap.h"
 #include "../rtengine/rt_math.h"
@@ -48,8 +49,6 @@ CropHandler::CropHandler() :
     cropW(0),
     cropH(0),
     enabled(false),
-    cropimg_width(0),
-    cropimg_height(0),
     cix(0),
     ciy(0),
     ciw(0),
@@ -298,9 +297,31 @@ void CropHandler::getPosition (int& x, int& y)
 }
 
 
+Glib::RefPtr<Gdk::Pixbuf> CropHandler::toPixbuf (std::unique_ptr<IImage8> img, float czoom, int imw, int imh)
+{
+    const int width = img->getWidth();
+    const int height = img->getHeight();
+    IImage8* const image = img.release();
+
+    // the pixbuf takes ownership of the image's buffer, which is then displayed without any copy at 1:1 scale
+    Glib::RefPtr<Gdk::Pixbuf> pixbuf = Gdk::Pixbuf::create_from_data (image->data, Gdk::COLORSPACE_RGB, false, 8, width, height, 3 * width,
+        [image](const guint8*) {
+            delete image;
+        }
+    );
+
+    if (czoom == 1.f) {
+        return imw == width && imh == height ? pixbuf : Gdk::Pixbuf::create_subpixbuf (pixbuf, 0, 0, imw, imh);
+    }
+
+    Glib::RefPtr<Gdk::Pixbuf> scaled = Gdk::Pixbuf::create (Gdk::COLORSPACE_RGB, false, 8, imw, imh);
+    pixbuf->scale (scaled, 0, 0, imw, imh, 0, 0, czoom, czoom, Gdk::INTERP_TILES);
+    return scaled;
+}
+
 void CropHandler::setDetailedCrop(
-    IImage8* im,
-    IImage8* imtrue,
+    std::unique_ptr<IImage8> im,
+    std::unique_ptr<IImage8> imtrue,
     const rtengine::procparams::ColorManagementParams& cmp,
     const rtengine::procparams::CropParams& cp,
     int ax,
@@ -319,20 +340,12 @@ void CropHandler::setDetailedCrop(
     *cropParams = cp;
     *colorParams = cmp;
 
-    if (!cropimg.empty()) {
-        cropimg.clear();
-    }
-
-    if (!cropimgtrue.empty()) {
-        cropimgtrue.clear();
-    }
+    cropimg.reset();
+    cropimgtrue.reset();
 
     if (ax == cropX && ay == cropY && aw == cropW && ah == cropH && askip == (zoom >= 1000 ? 1 : zoom / 10)) {
-        cropimg_width = im->getWidth ();
-        cropimg_height = im->getHeight ();
-        const std::size_t cropimg_size = 3 * cropimg_width * cropimg_height;
-        cropimg.assign(im->getData(), im->getData() + cropimg_size);
-        cropimgtrue.assign(imtrue->getData(), imtrue->getData() + cropimg_size);
+        cropimg = std::move(im);
+        cropimgtrue = std::move(imtrue);
         cix = ax;
         ciy = ay;
         ciw = aw;
@@ -351,20 +364,20 @@ void CropHandler::setDetailedCrop(
                         cropPixbuf.clear ();
 
                         if (!enabled) {
-                            cropimg.clear();
-                            cropimgtrue.clear();
+                            cropimg.reset();
+                            cropimgtrue.reset();
                             cimg.unlock ();
                             return false;
                         }
 
-                        if (!cropimg.empty()) {
+                        if (cropimg) {
                             if (cix == cropX && ciy == cropY && ciw == cropW && cih == cropH && cis == (zoom >= 1000 ? 1 : zoom / 10)) {
                                 // calculate final image size
                                 float czoom = zoom >= 1000 ?
                                     zoom / 1000.f :
                                     float((zoom/10) * 10) / float(zoom);
-                                int imw = cropimg_width * czoom;
-                                int imh = cropimg_height * czoom;
+                                int imw = cropimg->getWidth() * czoom;
+                                int imh = cropimg->getHeight() * czoom;
 
                                 if (imw > ww) {
                                     imw = ww;
@@ -374,19 +387,12 @@ void CropHandler::setDetailedCrop(
                                     imh = wh;
                                 }
 
-                                Glib::RefPtr<Gdk::Pixbuf> tmpPixbuf = Gdk::Pixbuf::create_from_data (cropimg.data(), Gdk::COLORSPACE_RGB, false, 8, cropimg_width, cropimg_height, 3 * cropimg_width);
-                                cropPixbuf = Gdk::Pixbuf::create (Gdk::COLORSPACE_RGB, false, 8, imw, imh);
-                                tmpPixbuf->scale (cropPixbuf, 0, 0, imw, imh, 0, 0, czoom, czoom, Gdk::INTERP_TILES);
-                                tmpPixbuf.clear ();
-
-                                Glib::RefPtr<Gdk::Pixbuf> tmpPixbuftrue = Gdk::Pixbuf::create_from_data (cropimgtrue.data(), Gdk::COLORSPACE_RGB, false, 8, cropimg_width, cropimg_height, 3 * cropimg_width);
-                                cropPixbuftrue = Gdk::Pixbuf::create (Gdk::COLORSPACE_RGB, false, 8, imw, imh);
-                                tmpPixbuftrue->scale (cropPixbuftrue, 0, 0, imw, imh, 0, 0, czoom, czoom, Gdk::INTERP_TILES);
-                                tmpPixbuftrue.clear ();
+                                cropPixbuf = toPixbuf (std::move(cropimg), czoom, imw, imh);
+                                cropPixbuftrue = toPixbuf (std::move(cropimgtrue), czoom, imw, imh);
                             }
 
-                            cropimg.clear();
-                            cropimgtrue.clear();
+                            cropimg.reset();
+                            cropimgtrue.reset();
                         }
 
                         cimg.unlock ();
@@ -460,8 +466,8 @@ void CropHandler::setEnabled (bool e)
         }
 
         cimg.lock();
-        cropimg.clear();
-        cropimgtrue.clear();
+        cropimg.reset();
+        cropimgtrue.reset();
         cropPixbuf.clear();
         cimg.unlock();
     } else {
@@ -20,7 +20,6 @@
 
 #include <atomic>
 #include <memory>
-#include <vector>
 
 #include <gtkmm.h>
 
@@ -88,8 +87,8 @@ public:
 
     // DetailedCropListener interface
     void setDetailedCrop(
-        rtengine::IImage8* im,
-        rtengine::IImage8* imworking,
+        std::unique_ptr<rtengine::IImage8> im,
+        std::unique_ptr<rtengine::IImage8> imworking,
         const rtengine::procparams::ColorManagementParams& cmp,
         const rtengine::procparams::CropParams& cp,
         int cx,
@@ -115,6 +114,7 @@ public:
 
 private:
     void    compDim ();
+    Glib::RefPtr<Gdk::Pixbuf> toPixbuf (std::unique_ptr<rtengine::IImage8> img, float czoom, int imw, int imh);
 
     int zoom;               // scale factor (e.g. 5 if 1:5 scale) ; if 1:1 scale and bigger, factor is multiplied by 1000  (i.e. 1000 for 1:1 scale, 2000 for 2:1, etc...)
     int ww, wh;             // size of the crop's canvas on the screen ; might be bigger than the displayed image, but not smaller
@@ -122,9 +122,9 @@ private:
     int cx, cy, cw, ch;     // position and size of the requested crop ; position expressed in image coordinates, so cx and cy might be negative and cw and ch higher than the image's 1:1 size
     int cropX, cropY, cropW, cropH; // cropPixbuf's displayed area (position and size), i.e. coordinates in 1:1 scale, i.e. cx, cy, cw & ch trimmed to the image's bounds
     bool enabled;
-    std::vector<unsigned char> cropimg;
-    std::vector<unsigned char> cropimgtrue;
-    int cropimg_width, cropimg_height, cix, ciy, ciw, cih, cis;
+    std::unique_ptr<rtengine::IImage8> cropimg;     // last crop received from the engine, waiting to be displayed
+    std::unique_ptr<rtengine::IImage8> cropimgtrue;
+    int cix, ciy, ciw, cih, cis;
     bool isLowUpdatePriority;
 
     rtengine::StagedImageProcessor* ipc;
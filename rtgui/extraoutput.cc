@@ -0,0 +1,254 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "extraoutput.h"
+
+#include "../rtengine/procparams.h"
+
+namespace
+{
+
+bool toInt(const std::string& value, int minValue, int maxValue, int& result)
+{
+    char* end = nullptr;
+    const long l = std::strtol(value.c_str(), &end, 10);
+
+    if (value.empty() || *end || l < minValue || l > maxValue) {
+        return false;
+    }
+
+    result = l;
+    return true;
+}
+
+}
+
+bool ExtraOutput::parse(const Glib::ustring& spec, const SaveFormat& defaultFormat, ExtraOutput& output, Glib::ustring& error)
+{
+    output = ExtraOutput();
+    output.saveFormat = defaultFormat;
+    output.saveFormat.saveParams = false;
+
+    const std::string s = spec;
+    std::string::size_type start = 0;
+    int bits = 0;
+    int isFloat = -1;
+
+    while (start <= s.size()) {
+        std::string::size_type end = s.find(',', start);
+
+        if (end == std::string::npos) {
+            end = s.size();
+        }
+
+        const std::string item = s.substr(start, end - start);
+        start = end + 1;
+
+        if (item.empty()) {
+            continue;
+        }
+
+        const std::string::size_type eq = item.find('=');
+
+        if (eq == std::string::npos) {
+            error = "missing value for \"" + item + "\"";
+            return false;
+        }
+
+        const std::string key = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+        bool valid = true;
+
+        if (key == "suffix") {
+            output.suffix = value;
+        } else if (key == "format") {
+            valid = value == "jpg" || value == "tif" || value == "png";
+            output.saveFormat.format = value;
+        } else if (key == "quality") {
+            valid = toInt(value, 0, 100, output.saveFormat.jpegQuality);
+        } else if (key == "subsampling") {
+            valid = toInt(value, 1, 3, output.saveFormat.jpegSubSamp);
+        } else if (key == "bits") {
+            valid = toInt(value, 8, 32, bits) && (bits == 8 || bits == 16 || bits == 32);
+        } else if (key == "float") {
+            valid = toInt(value, 0, 1, isFloat);
+        } else if (key == "scale") {
+            char* endp = nullptr;
+            output.scale = std::strtod(value.c_str(), &endp);
+            valid = !value.empty() && !*endp && output.scale > 0.0;
+        } else if (key == "width") {
+            valid = toInt(value, 1, 100000, output.width);
+        } else if (key == "height") {
+            valid = toInt(value, 1, 100000, output.height);
+        } else if (key == "longedge") {
+            valid = toInt(value, 1, 100000, output.longEdge);
+        } else if (key == "shortedge") {
+            valid = toInt(value, 1, 100000, output.shortEdge);
+        } else if (key == "sharpen") {
+            valid = toInt(value, 0, 1, output.sharpen);
+        } else if (key == "profile") {
+            output.profile = value;
+        } else {
+            error = "unknown key \"" + key + "\"";
+            return false;
+        }
+
+        if (!valid) {
+            error = "invalid value for \"" + key + "\"";
+            return false;
+        }
+    }
+
+    if (output.suffix.empty()) {
+        error = "missing suffix";
+        return false;
+    }
+
+    // like -b on the command line, an explicit depth without "float" is integer, except 32 bits which is float only
+    if (bits) {
+        output.saveFormat.tiffBits = bits;
+        output.saveFormat.pngBits = bits;
+        output.saveFormat.tiffFloat = isFloat == -1 ? bits == 32 : isFloat;
+    } else if (isFloat != -1) {
+        output.saveFormat.tiffFloat = isFloat;
+    }
+
+    if (output.saveFormat.format != "tif" && isFloat == 1) {
+        error = "floating-point output is TIFF only";
+        return false;
+    }
+
+    if (output.saveFormat.format == "jpg") {
+        if (bits && bits != 8) {
+            error = "JPEG output is 8 bits";
+            return false;
+        }
+    } else if (output.saveFormat.format == "png") {
+        if (bits == 32) {
+            error = "PNG output is 8 or 16 bits";
+            return false;
+        }
+
+        // a depth inherited from a TIFF main output
+        if (output.saveFormat.pngBits != 8) {
+            output.saveFormat.pngBits = 16;
+        }
+    } else if (output.saveFormat.format == "tif") {
+        if (output.saveFormat.tiffBits == 32 && !output.saveFormat.tiffFloat) {
+            if (bits || isFloat == 0) {
+                error = "32-bit TIFF output is floating-point only";
+                return false;
+            }
+
+            output.saveFormat.tiffFloat = true;
+        } else if (output.saveFormat.tiffBits == 8 && output.saveFormat.tiffFloat) {
+            if (bits || isFloat == 1) {
+                error = "floating-point TIFF output is 16 or 32 bits";
+                return false;
+            }
+
+            output.saveFormat.tiffFloat = false;
+        }
+    }
+
+    return true;
+}
+
+Glib::ustring ExtraOutput::getDepthDescription() const
+{
+    if (saveFormat.format == "jpg") {
+        return "8-bit integer";
+    } else if (saveFormat.format == "tif") {
+        return Glib::ustring::format(saveFormat.tiffBits) + (saveFormat.tiffFloat ? "-bit floating-point" : "-bit integer");
+    } else {
+        return Glib::ustring::format(saveFormat.pngBits) + "-bit integer";
+    }
+}
+
+std::vector<ExtraOutput> ExtraOutput::parseList(const std::vector<Glib::ustring>& specs, const SaveFormat& defaultFormat)
+{
+    std::vector<ExtraOutput> outputs;
+
+    for (const auto& spec : specs) {
+        ExtraOutput output;
+        Glib::ustring error;
+
+        if (parse(spec, defaultFormat, output, error)) {
+            outputs.push_back(output);
+        } else {
+            std::cerr << "Ignoring the extra output \"" << spec << "\": " << error << std::endl;
+        }
+    }
+
+    return outputs;
+}
+
+rtengine::OutputSpec ExtraOutput::getOutputSpec(const rtengine::procparams::ProcParams& params) const
+{
+    rtengine::OutputSpec spec(params);
+
+    if (scale > 0.0 || width > 0 || height > 0 || longEdge > 0 || shortEdge > 0) {
+        spec.resize.enabled = true;
+        spec.resize.method = "Lanczos";
+        spec.resize.allowUpscaling = false;
+
+        if (width > 0 && height > 0) {
+            spec.resize.dataspec = 3;
+            spec.resize.width = width;
+            spec.resize.height = height;
+        } else if (width > 0) {
+            spec.resize.dataspec = 1;
+            spec.resize.width = width;
+        } else if (height > 0) {
+            spec.resize.dataspec = 2;
+            spec.resize.height = height;
+        } else if (longEdge > 0) {
+            spec.resize.dataspec = 4;
+            spec.resize.longedge = longEdge;
+        } else if (shortEdge > 0) {
+            spec.resize.dataspec = 5;
+            spec.resize.shortedge = shortEdge;
+        } else {
+            spec.resize.dataspec = 0;
+            spec.resize.scale = scale;
+        }
+    }
+
+    if (sharpen >= 0) {
+        spec.prsharpening.enabled = sharpen;
+    }
+
+    if (!profile.empty()) {
+        spec.outputProfile = profile;
+    }
+
+    return spec;
+}
+
+std::vector<rtengine::OutputSpec> ExtraOutput::getOutputSpecs(const std::vector<ExtraOutput>& outputs, const rtengine::procparams::ProcParams& params)
+{
+    std::vector<rtengine::OutputSpec> specs;
+
+    for (const auto& output : outputs) {
+        specs.push_back(output.getOutputSpec(params));
+    }
+
+    return specs;
+}
@@ -0,0 +1,69 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+#include <glibmm/ustring.h>
+
+#include "options.h"
+
+#include "../rtengine/outputspec.h"
+
+/**
+ * An additional output of an export, rendered from the same processing as the main output
+ * (see rtengine::ProcessingJob::setExtraOutputs()) and saved next to it.
+ *
+ * It is specified as comma separated key=value pairs, e.g. "suffix=_web,format=jpg,quality=85,longedge=2048,sharpen=1":
+ *   suffix       appended to the file name of the main output, mandatory
+ *   format       "jpg", "tif" or "png", the format of the main output by default
+ *   quality      JPEG quality, 0-100
+ *   subsampling  JPEG chroma subsampling, 1-3
+ *   bits         bits per channel of the PNG (8 or 16) and TIFF (8, 16 or 32) outputs
+ *   float        1 for a floating-point TIFF output (16 or 32 bits, 32 bits is always floating-point)
+ *   scale, width, height, longedge, shortedge
+ *                Lanczos resize, width and height together fit the image in a box;
+ *                without any of them the resize settings of the processing profile are used
+ *   sharpen      1 or 0 to enable or disable the post-resize sharpening of the processing profile
+ *   profile      output ICC profile
+ */
+struct ExtraOutput {
+    Glib::ustring suffix;
+    SaveFormat saveFormat;
+    double scale = 0.0;
+    int width = 0;
+    int height = 0;
+    int longEdge = 0;
+    int shortEdge = 0;
+    int sharpen = -1;
+    Glib::ustring profile;
+
+    /** @return false if the specification is invalid, with the reason in error */
+    static bool parse(const Glib::ustring& spec, const SaveFormat& defaultFormat, ExtraOutput& output, Glib::ustring& error);
+
+    /** Parses the valid specifications, reporting the invalid ones on the standard error */
+    static std::vector<ExtraOutput> parseList(const std::vector<Glib::ustring>& specs, const SaveFormat& defaultFormat);
+
+    /** @return the bit depth actually written, e.g. "16-bit integer" */
+    Glib::ustring getDepthDescription() const;
+
+    /** @return the output parameters for an image processed with params */
+    rtengine::OutputSpec getOutputSpec(const rtengine::procparams::ProcParams& params) const;
+
+    /** @return the output parameters of each output of the list */
+    static std::vector<rtengine::OutputSpec> getOutputSpecs(const std::vector<ExtraOutput>& outputs, const rtengine::procparams::ProcParams& params);
+};
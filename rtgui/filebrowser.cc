@@ -665,6 +665,7 @@ FileBrowserEntry* FileBrowser::delEntry (const Glib::ustring& fname)
             ThumbBrowserEntryBase* entry = *i;
             entry->selected = false;
             fd.erase (i);
+            invalidateArrangement ();
             std::vector<ThumbBrowserEntryBase*>::iterator j = std::find (selected.begin(), selected.end(), entry);
 
             MYWRITERLOCK_RELEASE(l);
@@ -682,6 +683,7 @@ FileBrowserEntry* FileBrowser::delEntry (const Glib::ustring& fname)
                 lastClicked = nullptr;
             }
 
+            filterIndex.remove(static_cast<FileBrowserEntry*>(entry)->thumbnail);
             redraw ();
 
             return (static_cast<FileBrowserEntry*>(entry));
@@ -712,6 +714,8 @@ void FileBrowser::close ()
         }
 
         fd.clear ();
+        invalidateArrangement ();
+        filterIndex.clear ();
     }
 
     lastClicked = nullptr;
@@ -1500,6 +1504,7 @@ void FileBrowser::applyFilter (const BrowserFilter& filter)
 {
 
     this->filter = filter;
+    filterIndex.setFilter(filter);
 
     // remove items not complying the filter from the selection
     bool selchanged = false;
@@ -1563,57 +1568,8 @@ bool FileBrowser::checkFilter (ThumbBrowserEntryBase* entryb) const   // true ->
         return false;
     }
 
-    // return false if query is not satisfied
-    if (!filter.vFilterStrings.empty()) {
-        // check if image's FileName contains queryFileName (case insensitive)
-        // TODO should we provide case-sensitive search option via preferences?
-        std::string FileName = Glib::path_get_basename(entry->thumbnail->getFileName());
-        std::transform(FileName.begin(), FileName.end(), FileName.begin(), ::toupper);
-        int iFilenameMatch = 0;
-
-        for (const auto& filterString : filter.vFilterStrings) {
-            if (FileName.find(filterString) != std::string::npos) {
-                ++iFilenameMatch;
-                break;
-            }
-        }
-
-        if (filter.matchEqual) {
-            if (iFilenameMatch == 0) { //none of the vFilterStrings found in FileName
-                return false;
-            }
-        } else {
-            if (iFilenameMatch > 0) { // match is found for at least one of vFilterStrings in FileName
-                return false;
-            }
-        }
-    }
-
-    if (!filter.exifFilterEnabled) {
-        return true;
-    }
-
-    // check exif filter
-    const CacheImageData* cfs = entry->thumbnail->getCacheImageData();
-    double tol = 0.01;
-    double tol2 = 1e-8;
-
-    if (!cfs->exifValid) {
-        return (!filter.exifFilter.filterCamera || filter.exifFilter.cameras.count(cfs->getCamera()) > 0)
-               && (!filter.exifFilter.filterLens || filter.exifFilter.lenses.count(cfs->lens) > 0)
-               && (!filter.exifFilter.filterFiletype || filter.exifFilter.filetypes.count(cfs->filetype) > 0)
-               && (!filter.exifFilter.filterExpComp || filter.exifFilter.expcomp.count(cfs->expcomp) > 0);
-    }
-
-    return
-        (!filter.exifFilter.filterShutter || (rtengine::FramesMetaData::shutterFromString(rtengine::FramesMetaData::shutterToString(cfs->shutter)) >= filter.exifFilter.shutterFrom - tol2 && rtengine::FramesMetaData::shutterFromString(rtengine::FramesMetaData::shutterToString(cfs->shutter)) <= filter.exifFilter.shutterTo + tol2))
-        && (!filter.exifFilter.filterFNumber || (rtengine::FramesMetaData::apertureFromString(rtengine::FramesMetaData::apertureToString(cfs->fnumber)) >= filter.exifFilter.fnumberFrom - tol2 && rtengine::FramesMetaData::apertureFromString(rtengine::FramesMetaData::apertureToString(cfs->fnumber)) <= filter.exifFilter.fnumberTo + tol2))
-        && (!filter.exifFilter.filterFocalLen || (cfs->focalLen >= filter.exifFilter.focalFrom - tol && cfs->focalLen <= filter.exifFilter.focalTo + tol))
-        && (!filter.exifFilter.filterISO     || (cfs->iso >= filter.exifFilter.isoFrom && cfs->iso <= filter.exifFilter.isoTo))
-        && (!filter.exifFilter.filterExpComp || filter.exifFilter.expcomp.count(cfs->expcomp) > 0)
-        && (!filter.exifFilter.filterCamera  || filter.exifFilter.cameras.count(cfs->getCamera()) > 0)
-        && (!filter.exifFilter.filterLens    || filter.exifFilter.lenses.count(cfs->lens) > 0)
-        && (!filter.exifFilter.filterFiletype  || filter.exifFilter.filetypes.count(cfs->filetype) > 0);
+    // return false if query or exif filter is not satisfied
+    return filterIndex.matches(entry->thumbnail);
 }
 
 void FileBrowser::toTrashRequested (std::vector<FileBrowserEntry*> tbe)
@@ -2047,6 +2003,18 @@ void FileBrowser::storeCurrentValue()
 {
 }
 
+void FileBrowser::profileFilesChanged()
+{
+    // the file browser lives as long as the GUI, it updates the profile lists of all the listeners
+    idle_register.add(
+        []() -> bool
+        {
+            ProfileStore::getInstance()->updateIfChanged();
+            return false;
+        }
+    );
+}
+
 void FileBrowser::updateProfileList()
 {
     // submenu applmenu
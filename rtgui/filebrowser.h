@@ -26,6 +26,7 @@
 #include "exportpanel.h"
 #include "extprog.h"
 #include "filebrowserentry.h"
+#include "filebrowserindex.h"
 #include "lwbutton.h"
 #include "partialpastedlg.h"
 #include "pparamschangelistener.h"
@@ -130,6 +131,7 @@ protected:
     BatchPParamsChangeListener* bppcl;
     FileBrowserListener* tbl;
     BrowserFilter filter;
+    mutable FileBrowserIndex filterIndex;
     int numFiltered;
 
     void toTrashRequested   (std::vector<FileBrowserEntry*> tbe);
@@ -218,6 +220,7 @@ public:
     void storeCurrentValue() override;
     void updateProfileList() override;
     void restoreValue() override;
+    void profileFilesChanged() override;
 
     type_trash_changed trash_changed();
 };
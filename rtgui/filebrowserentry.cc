@@ -249,6 +249,14 @@ void FileBrowserEntry::_updateImage(rtengine::IImage8* img, double s, const rten
     MYWRITERLOCK(l, lockRW);
 
     redrawRequests--;
+
+    if (parent && !parent->isNearWindow(this)) {
+        // scrolled away meanwhile, requested again when it comes back into view
+        previewReleased = true;
+        delete img;
+        return;
+    }
+
     scale = s;
     *this->cropParams = cropParams;
 
@@ -297,7 +305,7 @@ bool FileBrowserEntry::motionNotify (int x, int y)
 
         if (coord.x != -1.) {
             if (!wasInside) {
-                inspector->switchImage(filename);
+                inspector->switchImage(filename, parent->getNeighbourFiles(this, options.inspectorPrefetch));
                 wasInside = true;
             }
             inspector->mouseMove(coord, 0);
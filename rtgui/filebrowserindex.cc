@@ -0,0 +1,243 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cctype>
+
+#include <glibmm/miscutils.h>
+
+#include "filebrowserindex.h"
+
+#include "cacheimagedata.h"
+#include "thumbnail.h"
+
+int FileBrowserIndex::Dictionary::getId(const std::string& value)
+{
+    const auto iter = ids.find(value);
+
+    if (iter != ids.end()) {
+        return iter->second;
+    }
+
+    const int id = values.size();
+    ids.emplace(value, id);
+    values.push_back(value);
+    return id;
+}
+
+void FileBrowserIndex::Dictionary::clear()
+{
+    ids.clear();
+    values.clear();
+}
+
+FileBrowserIndex::IdFilter::IdFilter() :
+    enabled(false)
+{
+}
+
+void FileBrowserIndex::IdFilter::set(bool enabled, const std::set<std::string>& values)
+{
+    this->enabled = enabled;
+    this->values = values;
+    accepted.clear();
+}
+
+bool FileBrowserIndex::IdFilter::accepts(int id, const Dictionary& dictionary)
+{
+    if (!enabled) {
+        return true;
+    }
+
+    // evaluates the ids added to the dictionary since the last call
+    for (std::size_t i = accepted.size(); i < dictionary.size(); ++i) {
+        accepted.push_back(values.count(dictionary.getValue(i)) > 0);
+    }
+
+    return accepted[id];
+}
+
+void FileBrowserIndex::IdFilter::reset()
+{
+    accepted.clear();
+}
+
+FileBrowserIndex::FileBrowserIndex() :
+    matchEqual(true),
+    exifFilterEnabled(false)
+{
+}
+
+void FileBrowserIndex::setFilter(const BrowserFilter& filter)
+{
+    MyMutex::MyLock lock(mutex);
+
+    filterStrings = filter.vFilterStrings;
+    matchEqual = filter.matchEqual;
+    exifFilterEnabled = filter.exifFilterEnabled;
+    exifFilter = filter.exifFilter;
+    cameraFilter.set(exifFilter.filterCamera, exifFilter.cameras);
+    lensFilter.set(exifFilter.filterLens, exifFilter.lenses);
+    filetypeFilter.set(exifFilter.filterFiletype, exifFilter.filetypes);
+    expcompFilter.set(exifFilter.filterExpComp, exifFilter.expcomp);
+}
+
+bool FileBrowserIndex::matches(const Thumbnail* thumbnail)
+{
+    MyMutex::MyLock lock(mutex);
+
+    const int row = getRow(thumbnail);
+
+    if (!filterStrings.empty()) {
+        // check if image's FileName contains queryFileName (case insensitive)
+        const std::string& name = names[row];
+        const bool found = std::any_of(
+            filterStrings.begin(),
+            filterStrings.end(),
+            [&name](const std::string& filterString)
+            {
+                return name.find(filterString) != std::string::npos;
+            }
+        );
+
+        if (found != matchEqual) {
+            return false;
+        }
+    }
+
+    if (!exifFilterEnabled) {
+        return true;
+    }
+
+    constexpr double tol = 0.01;
+    constexpr double tol2 = 1e-8;
+
+    if (!exifValid[row]) {
+        return cameraFilter.accepts(cameras[row], cameraDict)
+               && lensFilter.accepts(lenses[row], lensDict)
+               && filetypeFilter.accepts(filetypes[row], filetypeDict)
+               && expcompFilter.accepts(expcomps[row], expcompDict);
+    }
+
+    return
+        (!exifFilter.filterShutter || (shutters[row] >= exifFilter.shutterFrom - tol2 && shutters[row] <= exifFilter.shutterTo + tol2))
+        && (!exifFilter.filterFNumber || (fnumbers[row] >= exifFilter.fnumberFrom - tol2 && fnumbers[row] <= exifFilter.fnumberTo + tol2))
+        && (!exifFilter.filterFocalLen || (focalLens[row] >= exifFilter.focalFrom - tol && focalLens[row] <= exifFilter.focalTo + tol))
+        && (!exifFilter.filterISO || (isos[row] >= exifFilter.isoFrom && isos[row] <= exifFilter.isoTo))
+        && expcompFilter.accepts(expcomps[row], expcompDict)
+        && cameraFilter.accepts(cameras[row], cameraDict)
+        && lensFilter.accepts(lenses[row], lensDict)
+        && filetypeFilter.accepts(filetypes[row], filetypeDict);
+}
+
+void FileBrowserIndex::remove(const Thumbnail* thumbnail)
+{
+    MyMutex::MyLock lock(mutex);
+
+    const auto iter = rows.find(thumbnail);
+
+    if (iter != rows.end()) {
+        names[iter->second].clear();
+        freeRows.push_back(iter->second);
+        rows.erase(iter);
+    }
+}
+
+void FileBrowserIndex::clear()
+{
+    MyMutex::MyLock lock(mutex);
+
+    rows.clear();
+    freeRows.clear();
+    stamps.clear();
+    names.clear();
+    exifValid.clear();
+    shutters.clear();
+    fnumbers.clear();
+    focalLens.clear();
+    isos.clear();
+    cameras.clear();
+    lenses.clear();
+    filetypes.clear();
+    expcomps.clear();
+
+    cameraDict.clear();
+    lensDict.clear();
+    filetypeDict.clear();
+    expcompDict.clear();
+    cameraFilter.reset();
+    lensFilter.reset();
+    filetypeFilter.reset();
+    expcompFilter.reset();
+}
+
+int FileBrowserIndex::getRow(const Thumbnail* thumbnail)
+{
+    const auto iter = rows.find(thumbnail);
+
+    if (iter != rows.end()) {
+        if (stamps[iter->second] != thumbnail->getInfoStamp()) {
+            fillRow(iter->second, thumbnail);
+        }
+
+        return iter->second;
+    }
+
+    int row;
+
+    if (!freeRows.empty()) {
+        row = freeRows.back();
+        freeRows.pop_back();
+    } else {
+        row = stamps.size();
+        stamps.emplace_back();
+        names.emplace_back();
+        exifValid.emplace_back();
+        shutters.emplace_back();
+        fnumbers.emplace_back();
+        focalLens.emplace_back();
+        isos.emplace_back();
+        cameras.emplace_back();
+        lenses.emplace_back();
+        filetypes.emplace_back();
+        expcomps.emplace_back();
+    }
+
+    rows.emplace(thumbnail, row);
+    fillRow(row, thumbnail);
+    return row;
+}
+
+void FileBrowserIndex::fillRow(int row, const Thumbnail* thumbnail)
+{
+    // read before the data, so that a concurrent update leaves the row outdated
+    stamps[row] = thumbnail->getInfoStamp();
+
+    std::string name = Glib::path_get_basename(thumbnail->getFileName());
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    names[row] = std::move(name);
+
+    const CacheImageData* const cfs = thumbnail->getCacheImageData();
+    exifValid[row] = cfs->exifValid;
+    shutters[row] = rtengine::FramesMetaData::shutterFromString(rtengine::FramesMetaData::shutterToString(cfs->shutter));
+    fnumbers[row] = rtengine::FramesMetaData::apertureFromString(rtengine::FramesMetaData::apertureToString(cfs->fnumber));
+    focalLens[row] = cfs->focalLen;
+    isos[row] = cfs->iso;
+    cameras[row] = cameraDict.getId(cfs->getCamera());
+    lenses[row] = lensDict.getId(cfs->lens);
+    filetypes[row] = filetypeDict.getId(cfs->filetype);
+    expcomps[row] = expcompDict.getId(cfs->expcomp);
+}
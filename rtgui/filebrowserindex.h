@@ -0,0 +1,127 @@
+/*
+ *  This file is part of RawTherapee.
+ *
+ *  RawTherapee is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RawTherapee is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "browserfilter.h"
+#include "threadutils.h"
+
+#include "../rtengine/noncopyable.h"
+
+class Thumbnail;
+
+/**
+ * Column store of the metadata the file browser filters on, one row per thumbnail.
+ *
+ * The strings (camera, lens, file type, exposure compensation) are stored as ids of per column
+ * dictionaries, and the filter is compiled into a bitmap of the accepted ids, so that checking an
+ * entry doesn't compare any string. A row is (re)built the first time its thumbnail is checked after
+ * its metadata changed, which keeps the index up to date while the thumbnails are being loaded.
+ *
+ * The rank, the color label, the edited and the trash states aren't indexed, they change
+ * interactively and are cheap to read from the thumbnail.
+ */
+class FileBrowserIndex final :
+    public rtengine::NonCopyable
+{
+public:
+    FileBrowserIndex();
+
+    /** Compiles the query and the exif parts of the filter */
+    void setFilter(const BrowserFilter& filter);
+
+    /** @return true if the thumbnail complies with the query and the exif parts of the filter */
+    bool matches(const Thumbnail* thumbnail);
+
+    void remove(const Thumbnail* thumbnail);
+    void clear();
+
+private:
+    class Dictionary
+    {
+    public:
+        int getId(const std::string& value);
+        const std::string& getValue(int id) const
+        {
+            return values[id];
+        }
+        std::size_t size() const
+        {
+            return values.size();
+        }
+        void clear();
+
+    private:
+        std::unordered_map<std::string, int> ids;
+        std::vector<std::string> values;
+    };
+
+    // ids accepted by the filter, extended when new values enter the dictionary
+    class IdFilter
+    {
+    public:
+        IdFilter();
+
+        void set(bool enabled, const std::set<std::string>& values);
+        bool accepts(int id, const Dictionary& dictionary);
+        void reset();
+
+    private:
+        bool enabled;
+        std::set<std::string> values;
+        std::vector<char> accepted;
+    };
+
+    int getRow(const Thumbnail* thumbnail);
+    void fillRow(int row, const Thumbnail* thumbnail);
+
+    MyMutex mutex;
+
+    // rows
+    std::unordered_map<const Thumbnail*, int> rows;
+    std::vector<int> freeRows;
+    std::vector<unsigned int> stamps;
+    std::vector<std::string> names;     // upper case base names
+    std::vector<char> exifValid;
+    std::vector<double> shutters;       // normalized like the values displayed in the filter panel
+    std::vector<double> fnumbers;       // normalized like the values displayed in the filter panel
+    std::vector<double> focalLens;
+    std::vector<unsigned> isos;
+    std::vector<int> cameras;
+    std::vector<int> lenses;
+    std::vector<int> filetypes;
+    std::vector<int> expcomps;
+
+    Dictionary cameraDict;
+    Dictionary lensDict;
+    Dictionary filetypeDict;
+    Dictionary expcompDict;
+
+    // compiled filter
+    std::vector<std::string> filterStrings;
+    bool matchEqual;
+    bool exifFilterEnabled;
+    ExifFilterSettings exifFilter;
+    IdFilter cameraFilter;
+    IdFilter lensFilter;
+    IdFilter filetypeFilter;
+    IdFilter expcompFilter;
+};
@@ -16,6 +16,8 @@
  *  You should have received a copy of the GNU General Public License
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+
 #include "inspector.h"
 #include "guiutils.h"
 #include <gtkmm.h>
@@ -28,28 +30,38 @@
 #include "../rtengine/previewimage.h"
 #include "../rtengine/rt_math.h"
 
-InspectorBuffer::InspectorBuffer(const Glib::ustring &imagePath) : currTransform(0), fromRaw(false)
+InspectorBuffer::InspectorBuffer(const Glib::ustring &imagePath) : currTransform(0), fromRaw(false), size(0)
 {
-    if (!imagePath.empty() && Glib::file_test(imagePath, Glib::FILE_TEST_EXISTS) && !Glib::file_test(imagePath, Glib::FILE_TEST_IS_DIR)) {
-        imgPath = imagePath;
+    setImage(imagePath, decode(imagePath));
+}
+
+InspectorBuffer::InspectorBuffer(const Glib::ustring &imagePath, const Cairo::RefPtr<Cairo::ImageSurface> &imageSurface) : currTransform(0), fromRaw(false), size(0)
+{
+    setImage(imagePath, imageSurface);
+}
 
+Cairo::RefPtr<Cairo::ImageSurface> InspectorBuffer::decode(const Glib::ustring &imagePath)
+{
+    if (!imagePath.empty() && Glib::file_test(imagePath, Glib::FILE_TEST_EXISTS) && !Glib::file_test(imagePath, Glib::FILE_TEST_IS_DIR)) {
         // generate thumbnail image
         Glib::ustring ext = getExtension (imagePath);
 
-        if (ext.empty()) {
-            imgPath.clear();
-            return;
+        if (!ext.empty()) {
+            rtengine::PreviewImage pi(imagePath, ext, rtengine::PreviewImage::PIM_EmbeddedOrRaw);
+            return pi.getImage();
         }
+    }
 
-        rtengine::PreviewImage pi(imagePath, ext, rtengine::PreviewImage::PIM_EmbeddedOrRaw);
-        Cairo::RefPtr<Cairo::ImageSurface> imageSurface = pi.getImage();
+    return Cairo::RefPtr<Cairo::ImageSurface>();
+}
 
-        if (imageSurface) {
-            imgBuffer.setSurface(imageSurface);
-            fromRaw = true;
-        } else {
-            imgPath.clear();
-        }
+void InspectorBuffer::setImage(const Glib::ustring &imagePath, const Cairo::RefPtr<Cairo::ImageSurface> &imageSurface)
+{
+    if (imageSurface) {
+        imgPath = imagePath;
+        imgBuffer.setSurface(imageSurface);
+        fromRaw = true;
+        size = static_cast<std::size_t>(imageSurface->get_stride()) * imageSurface->get_height();
     }
 }
 
@@ -83,7 +95,7 @@ InspectorBuffer::~InspectorBuffer() {
 //    return deg;
 //}
 
-Inspector::Inspector () : currImage(nullptr), scaled(false), scale(1.0), zoomScale(1.0), zoomScaleBegin(1.0), active(false), pinned(false), dirty(false), fullscreen(true), keyDown(false), windowShowing(false)
+Inspector::Inspector () : currImage(nullptr), scaled(false), scale(1.0), zoomScale(1.0), zoomScaleBegin(1.0), active(false), pinned(false), dirty(false), fullscreen(true), keyDown(false), windowShowing(false), prefetchPool(nullptr)
 {
     set_name("Inspector");
 
@@ -116,6 +128,13 @@ Inspector::Inspector () : currImage(nullptr), scaled(false), scale(1.0), zoomSca
 
 Inspector::~Inspector()
 {
+    if (prefetchPool) {
+        // the remaining tasks return immediately once the queue is empty
+        cancelPrefetch();
+        delete prefetchPool;
+    }
+
+    idle_register.destroy();
     deleteBuffers();
     if (window)
         delete window;
@@ -563,7 +582,7 @@ void Inspector::mouseMove (rtengine::Coord2D pos, int transform)
     queue_draw();
 }
 
-void Inspector::switchImage (const Glib::ustring &fullPath)
+void Inspector::switchImage (const Glib::ustring &fullPath, const std::vector<Glib::ustring> &neighbours)
 {
     if (!active) {
         return;
@@ -574,6 +593,7 @@ void Inspector::switchImage (const Glib::ustring &fullPath)
     }
 
     next_image_path = fullPath;
+    next_neighbours = neighbours;
 
     // skip actual update of content when not visible
     if (window && !window->get_visible())
@@ -590,66 +610,163 @@ void Inspector::switchImage (const Glib::ustring &fullPath)
 bool Inspector::doSwitchImage()
 {
     Glib::ustring fullPath = next_image_path;
-    
-    // we first check the size of the list, it may have been changed in Preference
-    if (images.size() > size_t(options.maxInspectorBuffers)) {
-        // deleting the last entries
-        for (size_t i = images.size() - 1; i > size_t(options.maxInspectorBuffers - 1); --i) {
-            delete images.at(i);
-            images.at(i) = nullptr;
-        }
-
-        // resizing down
-        images.resize(options.maxInspectorBuffers);
-    }
 
     if (fullPath.empty()) {
         currImage = nullptr;
+        cancelPrefetch();
         queue_draw();
     } else {
-        bool found = false;
-
-        for (size_t i = 0; i < images.size(); ++i) {
-            if (images.at(i) != nullptr && images.at(i)->imgPath == fullPath) {
-                currImage = images.at(i);
-
-                // rolling the list 1 step to the beginning
-                for (size_t j = i; j < images.size() - 1; ++j) {
-                    images.at(j) = images.at(j + 1);
-                }
-
-                images.at(images.size() - 1) = currImage; // move the last used image to the tail
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
-            if (images.size() == size_t(options.maxInspectorBuffers)) {
-                // The list is full, delete the first entry
-                delete images.at(0);
-                images.erase(images.begin());
-            }
+        currImage = findBuffer(fullPath);
 
+        if (currImage) {
+            // move the last used image to the tail
+            images.erase(std::find(images.begin(), images.end(), currImage));
+            images.push_back(currImage);
+        } else {
             // Loading a new image
             InspectorBuffer *iBuffer = new InspectorBuffer(fullPath);
 
             // and add it to the tail
             if (!iBuffer->imgPath.empty()) {
                 images.push_back(iBuffer);
-                currImage = images.at(images.size() - 1);
+                currImage = iBuffer;
             } else {
                 delete iBuffer;
-                currImage = nullptr;
             }
         }
+
+        // the limits may have been changed in Preferences
+        trimBuffers();
+        prefetch(next_neighbours);
     }
 
     return true;
 }
 
+InspectorBuffer* Inspector::findBuffer(const Glib::ustring &fullPath) const
+{
+    for (auto image : images) {
+        if (image->imgPath == fullPath) {
+            return image;
+        }
+    }
+
+    return nullptr;
+}
+
+void Inspector::trimBuffers()
+{
+    // the prefetched images come on top of the number of images set in Preferences
+    const size_t maxCount = rtengine::max(options.maxInspectorBuffers, 1) + rtengine::max(options.inspectorPrefetch, 0);
+    const size_t maxSize = static_cast<size_t>(rtengine::max(options.inspectorCacheSize, 1)) << 20;
+    size_t size = 0;
+
+    for (auto image : images) {
+        size += image->size;
+    }
+
+    // deleting the least recently used images, but never the current one
+    for (auto iter = images.begin(); iter != images.end() && (images.size() > maxCount || size > maxSize);) {
+        if (*iter == currImage) {
+            ++iter;
+        } else {
+            size -= (*iter)->size;
+            delete *iter;
+            iter = images.erase(iter);
+        }
+    }
+}
+
+void Inspector::prefetch(const std::vector<Glib::ustring> &fullPaths)
+{
+    prefetchWanted.assign(fullPaths.begin(), fullPaths.begin() + rtengine::min<size_t>(fullPaths.size(), rtengine::max(options.inspectorPrefetch, 0)));
+
+    if (prefetchWanted.empty()) {
+        cancelPrefetch();
+        return;
+    }
+
+    if (!prefetchPool) {
+        prefetchPool = new Glib::ThreadPool(2, 0);
+    }
+
+    size_t count;
+
+    {
+        MyMutex::MyLock lock(prefetchMutex);
+
+        // the images queued for the previous position are not needed anymore
+        prefetchQueue.clear();
+
+        for (const auto &path : prefetchWanted) {
+            if (!findBuffer(path) && !prefetching.count(path)) {
+                prefetchQueue.push_back(path);
+            }
+        }
+
+        count = prefetchQueue.size();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        prefetchPool->push(sigc::mem_fun(*this, &Inspector::prefetchNext));
+    }
+}
+
+void Inspector::cancelPrefetch()
+{
+    prefetchWanted.clear();
+
+    MyMutex::MyLock lock(prefetchMutex);
+    prefetchQueue.clear();
+}
+
+void Inspector::prefetchNext()
+{
+    Glib::ustring fullPath;
+
+    {
+        MyMutex::MyLock lock(prefetchMutex);
+
+        if (prefetchQueue.empty()) {
+            return;
+        }
+
+        fullPath = prefetchQueue.front();
+        prefetchQueue.pop_front();
+        prefetching.insert(fullPath);
+    }
+
+    const Cairo::RefPtr<Cairo::ImageSurface> imageSurface = InspectorBuffer::decode(fullPath);
+
+    idle_register.add(
+        [this, fullPath, imageSurface]() -> bool
+        {
+            prefetched(fullPath, imageSurface);
+            return false;
+        }
+    );
+}
+
+void Inspector::prefetched(const Glib::ustring &fullPath, const Cairo::RefPtr<Cairo::ImageSurface> &imageSurface)
+{
+    {
+        MyMutex::MyLock lock(prefetchMutex);
+        prefetching.erase(fullPath);
+    }
+
+    // the mouse may have moved away from this image in the meantime
+    if (!active || !imageSurface || findBuffer(fullPath) || std::find(prefetchWanted.begin(), prefetchWanted.end(), fullPath) == prefetchWanted.end()) {
+        return;
+    }
+
+    images.push_back(new InspectorBuffer(fullPath, imageSurface));
+    trimBuffers();
+}
+
 void Inspector::deleteBuffers ()
 {
+    cancelPrefetch();
+
     for (size_t i = 0; i < images.size(); ++i) {
         if (images.at(i) != nullptr) {
             delete images.at(i);
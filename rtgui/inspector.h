@@ -18,9 +18,14 @@
  */
 #pragma once
 
+#include <deque>
+#include <set>
+#include <vector>
+
 #include <gtkmm.h>
 
 #include "guiutils.h"
+#include "threadutils.h"
 
 #include "../rtengine/coord2d.h"
 
@@ -34,9 +39,19 @@ public:
     Glib::ustring imgPath;
     int currTransform;  // coarse rotation from RT, not from shot orientation
     bool fromRaw;
+    std::size_t size;   // of the decoded image, in bytes
 
     explicit InspectorBuffer(const Glib::ustring &imgagePath);
+    InspectorBuffer(const Glib::ustring &imagePath, const Cairo::RefPtr<Cairo::ImageSurface> &imageSurface);
     //~InspectorBuffer();
+
+    /** @brief Decode the image to inspect, can be called from any thread
+     * @return an empty pointer if the image can't be decoded
+     */
+    static Cairo::RefPtr<Cairo::ImageSurface> decode(const Glib::ustring &imagePath);
+
+private:
+    void setImage(const Glib::ustring &imagePath, const Cairo::RefPtr<Cairo::ImageSurface> &imageSurface);
 };
 
 class Inspector final : public Gtk::DrawingArea
@@ -44,7 +59,7 @@ class Inspector final : public Gtk::DrawingArea
 
 private:
     rtengine::Coord2D center;
-    std::vector<InspectorBuffer*> images;
+    std::vector<InspectorBuffer*> images;  // least recently used first
     InspectorBuffer* currImage;
     bool scaled;  // fit image into window
     double scale; // current scale
@@ -60,8 +75,17 @@ private:
 
     sigc::connection delayconn;
     Glib::ustring next_image_path;
+    std::vector<Glib::ustring> next_neighbours;
     rtengine::Coord2D next_image_pos;
 
+    // background decoding of the images next to the inspected one
+    Glib::ThreadPool* prefetchPool;
+    MyMutex prefetchMutex;
+    std::deque<Glib::ustring> prefetchQueue;  // nearest first
+    std::set<Glib::ustring> prefetching;      // being decoded
+    std::vector<Glib::ustring> prefetchWanted;
+    IdleRegister idle_register;
+
     Gtk::Window *window;
     bool on_key_release(GdkEventKey *event);
     bool on_key_press(GdkEventKey *event);
@@ -86,6 +110,13 @@ private:
 
     bool doSwitchImage();
 
+    InspectorBuffer* findBuffer(const Glib::ustring &fullPath) const;
+    void trimBuffers();
+    void prefetch(const std::vector<Glib::ustring> &fullPaths);
+    void cancelPrefetch();
+    void prefetchNext();
+    void prefetched(const Glib::ustring &fullPath, const Cairo::RefPtr<Cairo::ImageSurface> &imageSurface);
+
 public:
     Inspector();
     ~Inspector() override;
@@ -109,8 +140,9 @@ public:
 
     /** @brief A new image is being flown over
      * @param fullPath Full path of the image that is being hovered inspect, or an empty string if out of any image.
+     * @param neighbours Full paths of the images next to it in the browse order, nearest first, to decode in the background
      */
-    void switchImage (const Glib::ustring &fullPath);
+    void switchImage (const Glib::ustring &fullPath, const std::vector<Glib::ustring> &neighbours = {});
 
     /** @brief Set the new coarse rotation transformation
      * @param transform A semi-bitfield coarse transformation using #defines from iimage.h
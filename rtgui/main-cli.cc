@@ -34,6 +34,8 @@
 #include "../rtengine/procparams.h"
 #include "../rtengine/profilestore.h"
 #include "../rtengine/rtengine.h"
+#include "cliserver.h"
+#include "extraoutput.h"
 #include "options.h"
 #include "soundman.h"
 #include "rtimage.h"
@@ -274,6 +276,8 @@ int processLineParams ( int argc, char **argv )
     bool isFloat = false;
     std::string outputType;
     unsigned errors = 0;
+    int serverJobs = 0;
+    std::vector<Glib::ustring> extraOutputSpecs;
 
     for ( int iArg = 1; iArg < argc; iArg++) {
         Glib::ustring currParam (argv[iArg]);
@@ -434,6 +438,29 @@ int processLineParams ( int argc, char **argv )
                     fast_export = true;
                     break;
 
+                case 'e':
+                    if (iArg + 1 < argc) {
+                        iArg++;
+                        extraOutputSpecs.push_back (fname_to_utf8 (argv[iArg]));
+                    } else {
+                        std::cerr << "Error: the -e switch has to be followed by the specification of an output!" << std::endl;
+                        deleteProcParams (processingParams);
+                        return -3;
+                    }
+
+                    break;
+
+                case 'l':
+                    serverJobs = currParam.size() < 3 ? 1 : atoi (currParam.substr (2).c_str());
+
+                    if (serverJobs < 1) {
+                        std::cerr << "Error: the value accompanying the -l switch has to be at least 1!" << std::endl;
+                        deleteProcParams (processingParams);
+                        return -3;
+                    }
+
+                    break;
+
                 case 'c': // MUST be last option
                     while (iArg + 1 < argc) {
                         iArg++;
@@ -538,9 +565,10 @@ int processLineParams ( int argc, char **argv )
                     std::cout << "Usage:" << std::endl;
                     std::cout << "  " << Glib::path_get_basename (argv[0]) << " -c <dir>|<files>   Convert files in batch with default parameters." << std::endl;
                     std::cout << "  " << Glib::path_get_basename (argv[0]) << " <other options> -c <dir>|<files>   Convert files in batch with your own settings." << std::endl;
+                    std::cout << "  " << Glib::path_get_basename (argv[0]) << " [-q] -l[<n>]   Process the jobs read from the standard input." << std::endl;
                     std::cout << std::endl;
                     std::cout << "Options:" << std::endl;
-                    std::cout << "  " << Glib::path_get_basename (argv[0]) << "[-o <output>|-O <output>] [-q] [-a] [-s|-S] [-p <one.pp3> [-p <two.pp3> ...] ] [-d] [ -j[1-100] -js<1-3> | -t[z] -b<8|16|16f|32> | -n -b<8|16> ] [-Y] [-f] -c <input>" << std::endl;
+                    std::cout << "  " << Glib::path_get_basename (argv[0]) << "[-o <output>|-O <output>] [-q] [-a] [-s|-S] [-p <one.pp3> [-p <two.pp3> ...] ] [-d] [ -j[1-100] -js<1-3> | -t[z] -b<8|16|16f|32> | -n -b<8|16> ] [-Y] [-f] [-e <spec> ...] -c <input>" << std::endl;
                     std::cout << std::endl;
                     std::cout << "  -c <files>       Specify one or more input files or folders." << std::endl;
                     std::cout << "                   When specifying folders, Rawtherapee will look for image file types which comply" << std::endl;
@@ -550,7 +578,8 @@ int processLineParams ( int argc, char **argv )
                     std::cout << "                   Saves output file alongside input file if -o is not specified." << std::endl;
                     std::cout << "  -O <file>|<dir>  Set output file or folder and copy " << pparamsExt << " file into it." << std::endl;
                     std::cout << "                   Saves output file alongside input file if -O is not specified." << std::endl;
-                    std::cout << "  -q               Quick-start mode. Does not load cached files to speedup start time." << std::endl;
+                    std::cout << "  -q               Quick-start mode. Does not load cached files, and only reads the lens and camera databases," << std::endl;
+                    std::cout << "                   dark frames and flat fields when they are needed, to speedup start time." << std::endl;
                     std::cout << "  -a               Process all supported image file types when specifying a folder, even those" << std::endl;
                     std::cout << "                   not currently selected in Preferences > File Browser > Parsed Extensions." << std::endl;
                     std::cout << "  -s               Use the existing sidecar file to build the processing parameters," << std::endl;
@@ -582,6 +611,18 @@ int processLineParams ( int argc, char **argv )
                     std::cout << "                   Compression is hard-coded to PNG_FILTER_PAETH, Z_RLE." << std::endl;
                     std::cout << "  -Y               Overwrite output if present." << std::endl;
                     std::cout << "  -f               Use the custom fast-export processing pipeline." << std::endl;
+                    std::cout << "  -e <spec>        Save an extra output of each image, rendered from the same processing, e.g." << std::endl;
+                    std::cout << "                   -e suffix=_web,format=jpg,quality=85,longedge=2048,sharpen=1" << std::endl;
+                    std::cout << "                   saves photo_web.jpg next to photo.tif. Other keys: \"subsampling\", \"bits\", \"float\"," << std::endl;
+                    std::cout << "                   \"scale\", \"width\", \"height\", \"shortedge\" and \"profile\" (output ICC profile)." << std::endl;
+                    std::cout << "                   The format defaults to the one of the main output. Can be repeated." << std::endl;
+                    std::cout << "  -l[<n>]          Server mode. Reads jobs from the standard input, one JSON object per line, e.g." << std::endl;
+                    std::cout << "                   {\"id\": \"1\", \"input\": \"photo.raw\", \"profiles\": [\"one.pp3\"], \"format\": \"tif\", \"bits\": 16}" << std::endl;
+                    std::cout << "                   and writes the result of each job as a JSON object on a line of the standard output." << std::endl;
+                    std::cout << "                   Other members: \"output\", \"default\", \"sidecar\", \"quality\", \"subsampling\", \"float\"," << std::endl;
+                    std::cout << "                   \"compress\", \"overwrite\" and \"fast\", matching the options above." << std::endl;
+                    std::cout << "                   Optionally, specify the number of jobs processed at a time (default value: 1)." << std::endl;
+                    std::cout << "                   The engine and the processing profiles are only loaded once for all jobs." << std::endl;
                     std::cout << std::endl;
                     std::cout << "Your " << pparamsExt << " files can be incomplete, RawTherapee will build the final values as follows:" << std::endl;
                     std::cout << "  1- A new processing profile is created using neutral values," << std::endl;
@@ -640,6 +681,13 @@ int processLineParams ( int argc, char **argv )
         }
     }
 
+    if (serverJobs > 0) {
+        // the jobs carry their own settings
+        deleteProcParams (processingParams);
+        CliServer server (serverJobs);
+        return server.run() > 0 ? -2 : 0;
+    }
+
     if ( !argv1.empty() ) {
         return 1;
     }
@@ -648,6 +696,31 @@ int processLineParams ( int argc, char **argv )
         return 2;
     }
 
+    // the extra outputs default to the format of the main output
+    SaveFormat mainFormat;
+    mainFormat.format = outputType.empty() ? "jpg" : outputType;
+    mainFormat.jpegQuality = mainFormat.format == "jpg" ? compression : 92;
+    mainFormat.jpegSubSamp = subsampling;
+    mainFormat.pngBits = bits;
+    mainFormat.tiffBits = bits;
+    mainFormat.tiffFloat = isFloat;
+    mainFormat.tiffUncompressed = compression == 0;
+    std::vector<ExtraOutput> extraOutputs;
+
+    for (const auto& spec : extraOutputSpecs) {
+        ExtraOutput extraOutput;
+        Glib::ustring error;
+
+        if (!ExtraOutput::parse (spec, mainFormat, extraOutput, error)) {
+            std::cerr << "Error: invalid output specification \"" << spec << "\": " << error << std::endl;
+            deleteProcParams (processingParams);
+            return -3;
+        }
+
+        std::cout << "Extra output \"" << extraOutput.suffix << "\" is " << extraOutput.getDepthDescription() << " " << extraOutput.saveFormat.format << "." << std::endl;
+        extraOutputs.push_back (extraOutput);
+    }
+
     if (useDefault) {
         rawParams = new rtengine::procparams::PartialProfile (true, true);
         Glib::ustring profPath = options.findProfilePath (options.defProfRaw);
@@ -803,7 +876,16 @@ int processLineParams ( int argc, char **argv )
         }
 
         // Process image
-        rtengine::IImagefloat* resultImage = rtengine::processImage (job, errorCode, nullptr);
+        std::vector<rtengine::IImagefloat*> resultImages;
+
+        if (extraOutputs.empty()) {
+            resultImages.push_back (rtengine::processImage (job, errorCode, nullptr));
+        } else {
+            job->setExtraOutputs (ExtraOutput::getOutputSpecs (extraOutputs, currentParams));
+            resultImages = rtengine::processImageOutputs (job, errorCode, nullptr);
+        }
+
+        rtengine::IImagefloat* resultImage = resultImages.empty() ? nullptr : resultImages[0];
 
         if ( !resultImage ) {
             errors++;
@@ -833,6 +915,31 @@ int processLineParams ( int argc, char **argv )
             }
         }
 
+        for (size_t i = 1; i < resultImages.size(); i++) {
+            const SaveFormat& extraFormat = extraOutputs[i - 1].saveFormat;
+            const Glib::ustring extraFile = removeExtension (outputFile) + extraOutputs[i - 1].suffix + "." + extraFormat.format;
+
+            if ( !overwriteFiles && Glib::file_test ( extraFile, Glib::FILE_TEST_EXISTS ) ) {
+                errors++;
+                std::cerr << extraFile << " already exists: use -Y option to overwrite. This output has been skipped." << std::endl;
+            } else {
+                if ( extraFormat.format == "jpg" ) {
+                    errorCode = resultImages[i]->saveAsJPEG ( extraFile, extraFormat.jpegQuality, extraFormat.jpegSubSamp );
+                } else if ( extraFormat.format == "tif" ) {
+                    errorCode = resultImages[i]->saveAsTIFF ( extraFile, extraFormat.tiffBits, extraFormat.tiffFloat, extraFormat.tiffUncompressed );
+                } else {
+                    errorCode = resultImages[i]->saveAsPNG ( extraFile, extraFormat.pngBits );
+                }
+
+                if (errorCode) {
+                    errors++;
+                    std::cerr << "Error saving to: " << extraFile << std::endl;
+                }
+            }
+
+            delete resultImages[i];
+        }
+
         ii->decreaseRef();
         delete resultImage;
     }
@@ -328,6 +328,7 @@ void Options::setDefaults()
     saveFormatBatch.tiffFloat = false;
     saveFormatBatch.tiffUncompressed = true;
     saveFormatBatch.saveParams = true;
+    extraOutputsBatch.clear();
 
     savePathTemplate = "%p1/converted/%f";
     savePathFolder = "";
@@ -469,6 +470,8 @@ void Options::setDefaults()
     inspectorWindow = false;
     zoomOnScroll = true;
     prevdemo = PD_Sidecar;
+    progressivePreview = true;
+    scopeSubsampling = 1;
 
     rgbDenoiseThreadLimit = 0;
 #if defined( _OPENMP ) && defined( __x86_64__ )
@@ -478,6 +481,8 @@ void Options::setDefaults()
 #endif
     filledProfile = false;
     maxInspectorBuffers = 2; //  a rather conservative value for low specced systems...
+    inspectorPrefetch = 2;
+    inspectorCacheSize = 512;
     inspectorDelay = 0;
     serializeTiffRead = true;
     measure = false;
@@ -1104,6 +1109,10 @@ void Options::readFromFile(Glib::ustring fname)
                     saveFormatBatch.saveParams = keyFile.get_boolean("Output", "SaveProcParamsBatch");
                 }
 
+                if (keyFile.has_key("Output", "ExtraOutputsBatch")) {
+                    extraOutputsBatch = keyFile.get_string_list("Output", "ExtraOutputsBatch");
+                }
+
                 if (keyFile.has_key("Output", "Path")) {
                     savePathTemplate = keyFile.get_string("Output", "Path");
                 }
@@ -1371,6 +1380,14 @@ void Options::readFromFile(Glib::ustring fname)
                     maxInspectorBuffers = keyFile.get_integer("Performance", "MaxInspectorBuffers");
                 }
 
+                if (keyFile.has_key("Performance", "InspectorPrefetch")) {
+                    inspectorPrefetch = keyFile.get_integer("Performance", "InspectorPrefetch");
+                }
+
+                if (keyFile.has_key("Performance", "InspectorCacheSize")) {
+                    inspectorCacheSize = keyFile.get_integer("Performance", "InspectorCacheSize");
+                }
+
                 if (keyFile.has_key("Performance", "InspectorDelay")) {
                     inspectorDelay = keyFile.get_integer("Performance", "InspectorDelay");
                 }
@@ -1379,6 +1396,14 @@ void Options::readFromFile(Glib::ustring fname)
                     prevdemo = (prevdemo_t)keyFile.get_integer("Performance", "PreviewDemosaicFromSidecar");
                 }
 
+                if (keyFile.has_key("Performance", "ProgressivePreview")) {
+                    progressivePreview = keyFile.get_boolean("Performance", "ProgressivePreview");
+                }
+
+                if (keyFile.has_key("Performance", "ScopeSubsampling")) {
+                    scopeSubsampling = std::min(8, std::max(1, keyFile.get_integer("Performance", "ScopeSubsampling")));
+                }
+
                 if (keyFile.has_key("Performance", "SerializeTiffRead")) {
                     serializeTiffRead = keyFile.get_boolean("Performance", "SerializeTiffRead");
                 }
@@ -2417,8 +2442,12 @@ void Options::saveToFile(Glib::ustring fname)
         keyFile.set_integer("Performance", "RgbDenoiseThreadLimit", rgbDenoiseThreadLimit);
         keyFile.set_integer("Performance", "ClutCacheSize", clutCacheSize);
         keyFile.set_integer("Performance", "MaxInspectorBuffers", maxInspectorBuffers);
+        keyFile.set_integer("Performance", "InspectorPrefetch", inspectorPrefetch);
+        keyFile.set_integer("Performance", "InspectorCacheSize", inspectorCacheSize);
         keyFile.set_integer("Performance", "InspectorDelay", inspectorDelay);
         keyFile.set_integer("Performance", "PreviewDemosaicFromSidecar", prevdemo);
+        keyFile.set_boolean("Performance", "ProgressivePreview", progressivePreview);
+        keyFile.set_integer("Performance", "ScopeSubsampling", scopeSubsampling);
         keyFile.set_boolean("Performance", "SerializeTiffRead", serializeTiffRead);
         keyFile.set_integer("Performance", "Measure", measure);
         keyFile.set_integer("Performance", "ChunkSizeAMAZE", chunkSizeAMAZE);
@@ -2447,6 +2476,8 @@ void Options::saveToFile(Glib::ustring fname)
         keyFile.set_boolean("Output", "TiffFloatBatch", saveFormatBatch.tiffFloat);
         keyFile.set_boolean("Output", "TiffUncompressedBatch", saveFormatBatch.tiffUncompressed);
         keyFile.set_boolean("Output", "SaveProcParamsBatch", saveFormatBatch.saveParams);
+        Glib::ArrayHandle<Glib::ustring> pextraout = extraOutputsBatch;
+        keyFile.set_string_list("Output", "ExtraOutputsBatch", pextraout);
 
         keyFile.set_string("Output", "PathTemplate", savePathTemplate);
         keyFile.set_string("Output", "PathFolder", savePathFolder);
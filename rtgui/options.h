@@ -203,6 +203,7 @@ public:
 
     bool savesParamsAtExit;
     SaveFormat saveFormat, saveFormatBatch;
+    std::vector<Glib::ustring> extraOutputsBatch; // specifications of the additional outputs of the batch queue, see ExtraOutput
     Glib::ustring savePathTemplate;
     Glib::ustring savePathFolder;
     bool saveUsePathTemplate;
@@ -372,10 +373,14 @@ public:
     Glib::ustring clutsDir;
     int rgbDenoiseThreadLimit; // maximum number of threads for the denoising tool ; 0 = use the maximum available
     int maxInspectorBuffers;   // maximum number of buffers (i.e. images) for the Inspector feature
+    int inspectorPrefetch;     // number of neighbouring images decoded in the background for the Inspector
+    int inspectorCacheSize;    // memory budget of the Inspector buffers, in MiB
     int inspectorDelay;
     int clutCacheSize;
     bool filledProfile;  // Used as reminder for the ProfilePanel "mode"
     prevdemo_t prevdemo; // Demosaicing method used for the <100% preview
+    bool progressivePreview; // Show a coarse preview first when heavy tools are enabled
+    int scopeSubsampling;    // Only one row out of scopeSubsampling is analyzed for the histograms and scopes
     bool serializeTiffRead;
     bool measure;
     size_t chunkSizeAMAZE;
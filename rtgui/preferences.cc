@@ -722,6 +722,19 @@ Gtk::Widget* Preferences::getPerformancePanel()
     fprevdemo->add(*hbprevdemo);
     vbPerformance->pack_start (*fprevdemo, Gtk::PACK_SHRINK, 4);
 
+    Gtk::Frame* fprogressive = Gtk::manage(new Gtk::Frame(M("PREFERENCES_PROGRESSIVEPREVIEW")));
+    Gtk::Box* hbprogressive = Gtk::manage(new Gtk::Box());
+    hbprogressive->set_spacing(4);
+    cprogressive = Gtk::manage(new Gtk::CheckButton(M("PREFERENCES_PROGRESSIVEPREVIEW_LABEL")));
+    cprogressive->set_tooltip_text(M("PREFERENCES_PROGRESSIVEPREVIEW_TOOLTIP"));
+    hbprogressive->pack_start(*cprogressive);
+    fprogressive->add(*hbprogressive);
+    vbPerformance->pack_start (*fprogressive, Gtk::PACK_SHRINK, 4);
+
+    Gtk::Frame* fscopes = Gtk::manage(new Gtk::Frame(M("PREFERENCES_SCOPES")));
+    placeSpinBox(fscopes, scopeSubsamplingSB, "PREFERENCES_SCOPES_SUBSAMPLING_LABEL", 0, 1, 5, 2, 1, 8, "PREFERENCES_SCOPES_SUBSAMPLING_TOOLTIP");
+    vbPerformance->pack_start (*fscopes, Gtk::PACK_SHRINK, 4);
+
     Gtk::Frame* ftiffserialize = Gtk::manage(new Gtk::Frame(M("PREFERENCES_SERIALIZE_TIFF_READ")));
     Gtk::Box* htiffserialize = Gtk::manage(new Gtk::Box());
     htiffserialize->set_spacing(4);
@@ -764,6 +777,8 @@ Gtk::Widget* Preferences::getPerformancePanel()
     finspect->set_label_align(0.025, 0.5);
     Gtk::Box* inspectorvb = Gtk::manage(new Gtk::Box(Gtk::ORIENTATION_VERTICAL));
     placeSpinBox(inspectorvb, maxInspectorBuffersSB, "PREFERENCES_INSPECT_MAXBUFFERS_LABEL", 0, 1, 5, 2, 1, 12, "PREFERENCES_INSPECT_MAXBUFFERS_TOOLTIP");
+    placeSpinBox(inspectorvb, inspectorPrefetchSB, "PREFERENCES_INSPECT_PREFETCH_LABEL", 0, 1, 2, 2, 0, 8, "PREFERENCES_INSPECT_PREFETCH_TOOLTIP");
+    placeSpinBox(inspectorvb, inspectorCacheSizeSB, "PREFERENCES_INSPECT_CACHESIZE_LABEL", 0, 64, 256, 5, 64, 16384, "PREFERENCES_INSPECT_CACHESIZE_TOOLTIP");
 
     Gtk::Box* insphb = Gtk::manage(new Gtk::Box());
     thumbnailInspectorMode = Gtk::manage(new Gtk::ComboBoxText());
@@ -1835,6 +1850,8 @@ void Preferences::storePreferences()
     moptions.rtSettings.iccDirectory = iccDir->get_filename();
 
     moptions.prevdemo = (prevdemo_t)cprevdemo->get_active_row_number ();
+    moptions.progressivePreview = cprogressive->get_active();
+    moptions.scopeSubsampling = scopeSubsamplingSB->get_value_as_int();
     moptions.serializeTiffRead = ctiffserialize->get_active();
 
     if (sdcurrent->get_active()) {
@@ -1911,6 +1928,8 @@ void Preferences::storePreferences()
     moptions.chunkSizeRGB = chunkSizeRGBSB->get_value_as_int();
     moptions.chunkSizeXT = chunkSizeXTSB->get_value_as_int();
     moptions.maxInspectorBuffers = maxInspectorBuffersSB->get_value_as_int();
+    moptions.inspectorPrefetch = inspectorPrefetchSB->get_value_as_int();
+    moptions.inspectorCacheSize = inspectorCacheSizeSB->get_value_as_int();
     moptions.rtSettings.thumbnail_inspector_mode = static_cast<rtengine::Settings::ThumbnailInspectorMode>(thumbnailInspectorMode->get_active_row_number());
 
 // Sounds only on Windows and Linux
@@ -1997,6 +2016,8 @@ void Preferences::fillPreferences()
     }
 
     cprevdemo->set_active (moptions.prevdemo);
+    cprogressive->set_active (moptions.progressivePreview);
+    scopeSubsamplingSB->set_value (moptions.scopeSubsampling);
     languages->set_active_text(moptions.language);
     ckbLangAutoDetect->set_active(moptions.languageAutoDetect);
     int themeNbr = getThemeRowNumber(moptions.theme);
@@ -2122,6 +2143,8 @@ void Preferences::fillPreferences()
     chunkSizeRCDSB->set_value (moptions.chunkSizeRCD);
     chunkSizeXTSB->set_value (moptions.chunkSizeXT);
     maxInspectorBuffersSB->set_value (moptions.maxInspectorBuffers);
+    inspectorPrefetchSB->set_value (moptions.inspectorPrefetch);
+    inspectorCacheSizeSB->set_value (moptions.inspectorCacheSize);
     thumbnailInspectorMode->set_active(int(moptions.rtSettings.thumbnail_inspector_mode));
 
     darkFrameDir->set_current_folder(moptions.rtSettings.darkFramesPath);
@@ -166,6 +166,8 @@ class Preferences final :
     Gtk::ComboBoxText* waveletTileSizeCombo;
 
     Gtk::ComboBoxText* cprevdemo;
+    Gtk::CheckButton* cprogressive;
+    Gtk::SpinButton* scopeSubsamplingSB;
     Gtk::CheckButton* ctiffserialize;
     Gtk::ComboBoxText* curveBBoxPosC;
 
@@ -204,6 +206,8 @@ class Preferences final :
     Gtk::SpinButton*  chunkSizeRGBSB;
     Gtk::SpinButton*  chunkSizeXTSB;
     Gtk::SpinButton*  maxInspectorBuffersSB;
+    Gtk::SpinButton*  inspectorPrefetchSB;
+    Gtk::SpinButton*  inspectorCacheSizeSB;
     Gtk::ComboBoxText *thumbnailInspectorMode;
 
     Gtk::CheckButton* ckbmenuGroupRank;
@@ -14,6 +14,7 @@
  *  You should have received a copy of the GNU General Public License
  *  along with RawTherapee.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <numeric>
 
 #include <glibmm/ustring.h>
@@ -30,7 +31,7 @@
 using namespace std;
 
 ThumbBrowserBase::ThumbBrowserBase ()
-    : location(THLOC_FILEBROWSER), inspector(nullptr), isInspectorActive(false), eventTime(0), lastClicked(nullptr), anchor(nullptr), previewHeight(options.thumbSize), numOfCols(1), lastRowHeight(0), arrangement(TB_Horizontal)
+    : location(THLOC_FILEBROWSER), inspector(nullptr), isInspectorActive(false), eventTime(0), lastClicked(nullptr), anchor(nullptr), previewHeight(options.thumbSize), numOfCols(1), lastRowHeight(0), arrangement(TB_Horizontal), arrangedValid(false), residentEntriesValid(false)
 {
     inW = -1;
     inH = -1;
@@ -62,9 +63,8 @@ void ThumbBrowserBase::scrollChanged ()
     {
         MYWRITERLOCK(l, entryRW);
 
-        for (size_t i = 0; i < fd.size(); i++) {
-            fd[i]->setOffset ((int)(hscroll.get_value()), (int)(vscroll.get_value()));
-        }
+        // only the entries in view need their offset, the others get it when they come into view
+        getEntriesInWindow(0);
     }
 
     internal.setPosition ((int)(hscroll.get_value()), (int)(vscroll.get_value()));
@@ -248,9 +248,10 @@ void ThumbBrowserBase::selectSet (ThumbBrowserEntryBase* clicked)
 
 static void scrollToEntry (double& h, double& v, int iw, int ih, ThumbBrowserEntryBase* entry)
 {
-    const int hMin = entry->getX();
+    // the scroll offset of the entry is only up to date if it's in view
+    const int hMin = entry->getStartX() - static_cast<int>(h);
     const int hMax = hMin + entry->getEffectiveWidth() - iw;
-    const int vMin = entry->getY();
+    const int vMin = entry->getStartY() - static_cast<int>(v);
     const int vMax = vMin + entry->getEffectiveHeight() - ih;
 
     if (hMin < 0) {
@@ -599,6 +600,7 @@ void ThumbBrowserBase::configScrollBars ()
 
 void ThumbBrowserBase::arrangeFiles(ThumbBrowserEntryBase* entry)
 {
+    invalidateArrangement();
 
     if (fd.empty()) {
         // nothing to arrange
@@ -821,6 +823,43 @@ void ThumbBrowserBase::enableInspector()
     }
 }
 
+std::vector<Glib::ustring> ThumbBrowserBase::getNeighbourFiles(const ThumbBrowserEntryBase* entry, int count) const
+{
+    std::vector<Glib::ustring> files;
+    const auto pos = std::find(fd.begin(), fd.end(), entry);
+
+    if (pos == fd.end()) {
+        return files;
+    }
+
+    auto next = pos;
+    auto prev = std::vector<ThumbBrowserEntryBase*>::const_reverse_iterator(pos);
+    bool forward = true;
+
+    while (static_cast<int>(files.size()) < count && (next != fd.end() || prev != fd.rend())) {
+        if (forward && next != fd.end()) {
+            while (++next != fd.end() && (*next)->filtered) {}
+
+            if (next != fd.end()) {
+                files.push_back((*next)->filename);
+            }
+        } else if (!forward && prev != fd.rend()) {
+            while (prev != fd.rend() && (*prev)->filtered) {
+                ++prev;
+            }
+
+            if (prev != fd.rend()) {
+                files.push_back((*prev)->filename);
+                ++prev;
+            }
+        }
+
+        forward = !forward;
+    }
+
+    return files;
+}
+
 bool ThumbBrowserBase::Internal::on_configure_event(GdkEventConfigure *configure_event)
 {
     return true;
@@ -864,9 +903,11 @@ bool ThumbBrowserBase::Internal::on_query_tooltip (int x, int y, bool keyboard_t
     {
         MYREADERLOCK(l, parent->entryRW);
 
-        for (size_t i = 0; i < parent->fd.size(); i++)
-            if (parent->fd[i]->drawable && parent->fd[i]->inside (x, y)) {
-                std::tie(ttip, useMarkup) = parent->fd[i]->getToolTip (x, y);
+        const auto entries = parent->getEntriesInWindow(0);
+
+        for (auto entry = entries.first; entry != entries.second; ++entry)
+            if ((*entry)->inside (x, y)) {
+                std::tie(ttip, useMarkup) = (*entry)->getToolTip (x, y);
                 break;
             }
     }
@@ -943,15 +984,16 @@ void ThumbBrowserBase::buttonPressed (int x, int y, int button, GdkEventType typ
     {
         MYREADERLOCK(l, entryRW);
 
-        for (size_t i = 0; i < fd.size(); i++)
-            if (fd[i]->drawable) {
-                if (fd[i]->inside (x, y) && fd[i]->insideWindow (clx, cly, clw, clh)) {
-                    fileDescr = fd[i];
-                }
+        const auto entries = getEntriesInWindow(0);
 
-                bool b = fd[i]->pressNotify (button, type, state, x, y);
-                handled = handled || b;
+        for (auto entry = entries.first; entry != entries.second; ++entry) {
+            if ((*entry)->inside (x, y) && (*entry)->insideWindow (clx, cly, clw, clh)) {
+                fileDescr = *entry;
             }
+
+            bool b = (*entry)->pressNotify (button, type, state, x, y);
+            handled = handled || b;
+        }
     }
 
     if (handled || (fileDescr && fileDescr->processing)) {
@@ -1010,14 +1052,15 @@ bool ThumbBrowserBase::Internal::on_draw(const ::Cairo::RefPtr< Cairo::Context>
     {
         MYWRITERLOCK(l, parent->entryRW);
 
-        for (size_t i = 0; i < parent->fd.size() && !dirty; i++) { // if dirty meanwhile, cancel and wait for next redraw
-            if (!parent->fd[i]->drawable || !parent->fd[i]->insideWindow (0, 0, w, h)) {
-                parent->fd[i]->updatepriority = false;
-            } else {
-                parent->fd[i]->updatepriority = true;
-                parent->fd[i]->draw (cr);
+        const auto entries = parent->getEntriesInWindow(0);
+
+        for (auto entry = entries.first; entry != entries.second && !dirty; ++entry) { // if dirty meanwhile, cancel and wait for next redraw
+            if ((*entry)->insideWindow (0, 0, w, h)) {
+                (*entry)->draw (cr);
             }
         }
+
+        parent->updateResidentEntries();
     }
     style->render_frame(cr, 0., 0., w, h);
 
@@ -1060,9 +1103,12 @@ bool ThumbBrowserBase::Internal::on_button_release_event (GdkEventButton* event)
 
     MYREADERLOCK(l, parent->entryRW);
 
-    for (size_t i = 0; i < parent->fd.size(); i++)
-        if (parent->fd[i]->drawable && parent->fd[i]->insideWindow (0, 0, w, h)) {
-            ThumbBrowserEntryBase* tbe = parent->fd[i];
+    // copied, the arrangement may change while the lock is released
+    const auto entries = parent->getEntriesInWindow(0);
+    const std::vector<ThumbBrowserEntryBase*> inWindow(entries.first, entries.second);
+
+    for (const auto tbe : inWindow)
+        if (tbe->insideWindow (0, 0, w, h)) {
             MYREADERLOCK_RELEASE(l);
             // This will require a Writer access...
             tbe->releaseNotify (event->button, event->type, event->state, (int)event->x, (int)event->y);
@@ -1080,9 +1126,11 @@ bool ThumbBrowserBase::Internal::on_motion_notify_event (GdkEventMotion* event)
 
     MYREADERLOCK(l, parent->entryRW);
 
-    for (size_t i = 0; i < parent->fd.size(); i++)
-        if (parent->fd[i]->drawable && parent->fd[i]->insideWindow (0, 0, w, h)) {
-            parent->fd[i]->motionNotify ((int)event->x, (int)event->y);
+    const auto entries = parent->getEntriesInWindow(0);
+
+    for (auto entry = entries.first; entry != entries.second; ++entry)
+        if ((*entry)->insideWindow (0, 0, w, h)) {
+            (*entry)->motionNotify ((int)event->x, (int)event->y);
         }
 
     return true;
@@ -1268,6 +1316,104 @@ void ThumbBrowserBase::insertEntry (ThumbBrowserEntryBase* entry)
     redraw ();
 }
 
+bool ThumbBrowserBase::isNearWindow (const ThumbBrowserEntryBase* entry)
+{
+    if (!entry->drawable) {
+        return false;
+    }
+
+    const int margin = getResidentMargin();
+
+    if (arrangement == TB_Horizontal) {
+        const int x = hscroll.get_value();
+        return entry->getStartX() + entry->getEffectiveWidth() >= x - margin && entry->getStartX() <= x + internal.get_width() + margin;
+    } else {
+        const int y = vscroll.get_value();
+        return entry->getStartY() + entry->getEffectiveHeight() >= y - margin && entry->getStartY() <= y + internal.get_height() + margin;
+    }
+}
+
+void ThumbBrowserBase::invalidateArrangement ()
+{
+    arrangedValid = false;
+    residentEntriesValid = false;
+}
+
+std::pair<ThumbBrowserBase::ArrangedIterator, ThumbBrowserBase::ArrangedIterator> ThumbBrowserBase::getEntriesInWindow (int margin)
+{
+    if (!arrangedValid) {
+        arranged.clear();
+
+        for (const auto entry : fd) {
+            if (entry->drawable) {
+                arranged.push_back(entry);
+            }
+        }
+
+        arrangedValid = true;
+    }
+
+    // the arranged entries are sorted by position along the scrolling direction
+    const int x = hscroll.get_value();
+    const int y = vscroll.get_value();
+    ArrangedIterator begin;
+    ArrangedIterator end;
+
+    if (arrangement == TB_Horizontal) {
+        const int from = x - margin;
+        const int to = x + internal.get_width() + margin;
+        begin = std::partition_point(arranged.cbegin(), arranged.cend(), [from](const ThumbBrowserEntryBase* entry) { return entry->getStartX() + entry->getEffectiveWidth() < from; });
+        end = std::partition_point(begin, arranged.cend(), [to](const ThumbBrowserEntryBase* entry) { return entry->getStartX() <= to; });
+    } else {
+        const int from = y - margin;
+        const int to = y + internal.get_height() + margin;
+        begin = std::partition_point(arranged.cbegin(), arranged.cend(), [from](const ThumbBrowserEntryBase* entry) { return entry->getStartY() + entry->getEffectiveHeight() < from; });
+        end = std::partition_point(begin, arranged.cend(), [to](const ThumbBrowserEntryBase* entry) { return entry->getStartY() <= to; });
+    }
+
+    for (auto entry = begin; entry != end; ++entry) {
+        (*entry)->setOffset(x, y);
+    }
+
+    return {begin, end};
+}
+
+void ThumbBrowserBase::updateResidentEntries ()
+{
+    const auto entries = getEntriesInWindow(getResidentMargin());
+    const int w = internal.get_width();
+    const int h = internal.get_height();
+
+    // after a rearrangement, any entry may have left the surroundings of the visible area
+    const std::vector<ThumbBrowserEntryBase*>& previous = residentEntriesValid ? residentEntries : fd;
+
+    for (const auto entry : previous) {
+        entry->resident = false;
+    }
+
+    for (auto entry = entries.first; entry != entries.second; ++entry) {
+        (*entry)->resident = true;
+        (*entry)->updatepriority = (*entry)->insideWindow (0, 0, w, h);
+        (*entry)->restorePreview();
+    }
+
+    for (const auto entry : previous) {
+        if (!entry->resident) {
+            entry->updatepriority = false;
+            entry->releasePreview();
+        }
+    }
+
+    residentEntries.assign(entries.first, entries.second);
+    residentEntriesValid = true;
+}
+
+int ThumbBrowserBase::getResidentMargin ()
+{
+    // one page before and after the visible area
+    return arrangement == TB_Horizontal ? internal.get_width() : internal.get_height();
+}
+
 void ThumbBrowserBase::getScrollPosition (double& h, double& v)
 {
     h = hscroll.get_value ();
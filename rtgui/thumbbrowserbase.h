@@ -19,6 +19,8 @@
 #pragma once
 
 #include <set>
+#include <utility>
+#include <vector>
 
 #include <gtkmm.h>
 
@@ -141,6 +143,9 @@ public:
     }
     void disableInspector();
     void enableInspector();
+    /** @return the files of the visible entries next to entry, nearest first, alternating forwards and backwards.
+      * entryRW has to be locked by the caller. */
+    std::vector<Glib::ustring> getNeighbourFiles(const ThumbBrowserEntryBase* entry, int count) const;
     enum Arrangement {TB_Horizontal, TB_Vertical};
     void configScrollBars ();
     void scrollChanged ();
@@ -189,6 +194,22 @@ protected:
     void arrangeFiles (ThumbBrowserEntryBase* entry = nullptr);
     void zoomChanged (bool zoomIn);
 
+    // The drawable entries in display order, so that the entries around the visible area are found
+    // without going through all of them. Must be invalidated, with entryRW locked, when entries are removed.
+    using ArrangedIterator = std::vector<ThumbBrowserEntryBase*>::const_iterator;
+    std::vector<ThumbBrowserEntryBase*> arranged;
+    bool arrangedValid;
+    // the entries near the visible area, the only ones keeping their preview
+    std::vector<ThumbBrowserEntryBase*> residentEntries;
+    bool residentEntriesValid;
+
+    void invalidateArrangement ();
+    /** @return the arranged entries within margin pixels of the visible area, with their scroll offset updated */
+    std::pair<ArrangedIterator, ArrangedIterator> getEntriesInWindow (int margin);
+    /** Releases the previews of the entries which left the surroundings of the visible area, and requests the previews of the ones which entered it */
+    void updateResidentEntries ();
+    int getResidentMargin ();
+
 public:
 
     ThumbBrowserBase ();
@@ -215,6 +236,8 @@ public:
     void refreshEditedState (const std::set<Glib::ustring>& efiles);
 
     void insertEntry (ThumbBrowserEntryBase* entry);
+    /** @return true if the entry is drawable and near enough of the visible area to keep its preview */
+    bool isNearWindow (const ThumbBrowserEntryBase* entry);
 
     void getScrollPosition (double& h, double& v);
     void setScrollPosition (double h, double v);
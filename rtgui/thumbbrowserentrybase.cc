@@ -135,6 +135,7 @@ ThumbBrowserEntryBase::ThumbBrowserEntryBase (const Glib::ustring& fname, Thumbn
     textGap(6),
     sideMargin(8),
     lowerMargin(8),
+    previewReleased(false),
     dispname(Glib::path_get_basename(fname)),
     buttonSet(nullptr),
     width(0),
@@ -165,6 +166,7 @@ ThumbBrowserEntryBase::ThumbBrowserEntryBase (const Glib::ustring& fname, Thumbn
     edited(false),
     recentlysaved(false),
     updatepriority(false),
+    resident(false),
     withFilename(WFNAME_NONE)
 {
 }
@@ -557,7 +559,12 @@ void ThumbBrowserEntryBase::resize (int h)
 
     if (preh != old_preh || prew != old_prew) { // if new thumbnail height or new orientation
         preview.clear();
-        refreshThumbnailImage ();
+
+        if (parent->isNearWindow(this)) {
+            refreshThumbnailImage ();
+        } else {
+            previewReleased = true;
+        }
     } else if (backBuffer) {
         backBuffer->setDirty(true);    // This will force a backBuffer update on queue_draw
     }
@@ -659,6 +666,10 @@ void ThumbBrowserEntryBase::setOffset (int x, int y)
 {
     MYWRITERLOCK(l, lockRW);
 
+    if (ofsX == -x && ofsY == -y) {
+        return;
+    }
+
     ofsX = -x;
     ofsY = -y;
 
@@ -667,6 +678,25 @@ void ThumbBrowserEntryBase::setOffset (int x, int y)
     }
 }
 
+void ThumbBrowserEntryBase::releasePreview ()
+{
+    MYWRITERLOCK(l, lockRW);
+
+    if (!preview.empty() || backBuffer) {
+        std::vector<guint8>().swap(preview);
+        backBuffer.reset();
+        previewReleased = true;
+    }
+}
+
+void ThumbBrowserEntryBase::restorePreview ()
+{
+    if (previewReleased) {
+        previewReleased = false;
+        refreshThumbnailImage ();
+    }
+}
+
 bool ThumbBrowserEntryBase::inside (int x, int y) const
 {
 
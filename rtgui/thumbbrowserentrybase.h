@@ -62,6 +62,7 @@ protected:
     MyRWMutex lockRW;  // Locks access to all image thumb changing actions
 
     std::vector<guint8> preview;  // holds the preview image. used in updateBackBuffer.
+    bool previewReleased;         // the preview has to be requested again when the entry comes near the visible area
 
     Glib::ustring dispname;
 
@@ -118,6 +119,7 @@ public:
     bool edited;
     bool recentlysaved;
     bool updatepriority;
+    bool resident;      // near the visible area, maintained by the parent browser
     eWithFilename withFilename;
 
     explicit ThumbBrowserEntryBase (const Glib::ustring& fname, Thumbnail *thm);
@@ -177,6 +179,11 @@ public:
     void setPosition (int x, int y, int w, int h);
     void setOffset (int x, int y);
 
+    /** Frees the preview and the back buffer of an entry far from the visible area */
+    void releasePreview ();
+    /** Requests the preview again if it has been released */
+    void restorePreview ();
+
     bool compare (const ThumbBrowserEntryBase& other, Options::SortMethod method) const
     {
         int cmp = 0;
@@ -63,6 +63,7 @@ Thumbnail::Thumbnail(CacheManager* cm, const Glib::ustring& fname, CacheImageDat
     lastScale(0),
     initial_(false)
 {
+    touchInfo ();
 
     loadProcParams ();
 
@@ -101,7 +102,7 @@ Thumbnail::Thumbnail(CacheManager* cm, const Glib::ustring& fname, const std::st
     lastScale(0.0),
     initial_(true)
 {
-
+    touchInfo ();
 
     cfs.md5 = md5;
     loadProcParams ();
@@ -193,6 +194,9 @@ void Thumbnail::_generateThumbnailImage ()
 
         generateExifDateTimeStrings ();
     }
+
+    // supported, format and the exif data changed, even when infoFromImage hasn't been called
+    touchInfo ();
 }
 
 bool Thumbnail::isSupported () const
@@ -868,9 +872,16 @@ int Thumbnail::infoFromImage (const Glib::ustring& fname, std::unique_ptr<rtengi
     }
 
     delete idata;
+    touchInfo ();
     return deg;
 }
 
+void Thumbnail::touchInfo ()
+{
+    static std::atomic<unsigned int> lastStamp(0);
+    infoStamp = ++lastStamp;
+}
+
 /*
  * Read all thumbnail's data from the cache; build and save them if doesn't exist - NON PROTECTED
  * This includes:
@@ -1008,6 +1019,7 @@ void Thumbnail::setFileName (const Glib::ustring &fn)
 
     fname = fn;
     cfs.md5 = ::getMD5 (fname);
+    touchInfo ();
 }
 
 int Thumbnail::getRank  () const
@@ -18,6 +18,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -78,6 +79,10 @@ class Thumbnail
 
     bool            initial_;
 
+    // changes each time the file name or the metadata of cfs change, unique among all the thumbnails
+    std::atomic<unsigned int> infoStamp;
+    void            touchInfo ();
+
     // vector of listeners
     std::vector<ThumbnailListener*> listeners;
 
@@ -138,6 +143,10 @@ public:
         return fname;
     }
     void            setFileName (const Glib::ustring &fn);
+    unsigned int    getInfoStamp () const
+    {
+        return infoStamp;
+    }
 
     bool            isSupported () const;
 